@@ -0,0 +1,54 @@
+#include "asset_bundle.h"
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+
+static bool validBundle(const AssetBundle& bundle) {
+    const MappedFile& mapping = bundle.mapping;
+    if (mapping.size < sizeof(BundleHeader)) return false;
+
+    const BundleHeader* header = (const BundleHeader*)mapping.data;
+    if (memcmp(header->magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0 || header->version != BUNDLE_VERSION) {
+        return false;
+    }
+    if (header->count > (mapping.size - sizeof(BundleHeader)) / sizeof(BundleEntry)) return false;
+
+    const BundleEntry* entries = (const BundleEntry*)(mapping.data + sizeof(BundleHeader));
+    for (uint32_t i = 0; i < header->count; i++) {
+        const BundleEntry& entry = entries[i];
+        if (memchr(entry.name, '\0', BUNDLE_NAME_LENGTH) == nullptr) return false;
+        if (entry.offset > mapping.size || entry.size > mapping.size - entry.offset) return false;
+    }
+    return true;
+}
+
+bool openAssetBundle(AssetBundle& bundle, const char* path) {
+    if (!mapFile(bundle.mapping, path)) return false;
+
+    if (!validBundle(bundle)) {
+        cerr << "File " << path << " khong phai goi tai nguyen hop le!" << endl;
+        closeAssetBundle(bundle);
+        return false;
+    }
+    bundle.count = ((const BundleHeader*)bundle.mapping.data)->count;
+    bundle.entries = (const BundleEntry*)(bundle.mapping.data + sizeof(BundleHeader));
+    return true;
+}
+
+void closeAssetBundle(AssetBundle& bundle) {
+    unmapFile(bundle.mapping);
+    bundle.entries = nullptr;
+    bundle.count = 0;
+}
+
+bool findBundleAsset(const AssetBundle& bundle, const char* name, const char*& data, size_t& size) {
+    for (uint32_t i = 0; i < bundle.count; i++) {
+        if (strcmp(bundle.entries[i].name, name) != 0) continue;
+        data = bundle.mapping.data + bundle.entries[i].offset;
+        size = (size_t)bundle.entries[i].size;
+        return true;
+    }
+    return false;
+}
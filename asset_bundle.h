@@ -0,0 +1,40 @@
+#ifndef ASSET_BUNDLE_H
+#define ASSET_BUNDLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "mapped_file.h"
+
+// assets.pak layout, little-endian:
+//   BundleHeader, then `count` BundleEntry records, then the file contents,
+//   each starting on a BUNDLE_ALIGNMENT boundary. Offsets are from the start
+//   of the file, so an asset is a pointer into the mapping with no copy.
+const char BUNDLE_MAGIC[8] = {'S', 'D', 'K', 'P', 'A', 'K', '1', '\0'};
+const uint32_t BUNDLE_VERSION = 1;
+const size_t BUNDLE_NAME_LENGTH = 48;
+const size_t BUNDLE_ALIGNMENT = 16;
+
+struct BundleHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+};
+
+struct BundleEntry {
+    char name[BUNDLE_NAME_LENGTH];
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct AssetBundle {
+    MappedFile mapping;
+    const BundleEntry* entries = nullptr;
+    uint32_t count = 0;
+};
+
+bool openAssetBundle(AssetBundle& bundle, const char* path);
+void closeAssetBundle(AssetBundle& bundle);
+// Points `data` into the mapping; valid until closeAssetBundle.
+bool findBundleAsset(const AssetBundle& bundle, const char* name, const char*& data, size_t& size);
+
+#endif
@@ -0,0 +1,186 @@
+#include "asset_loader.h"
+#include <iostream>
+#include <SDL_image.h>
+
+using namespace std;
+
+
+struct AssetFollowUp {
+    Asset* asset;
+    function<bool()> build;
+    int waiting;
+};
+
+static void finishAsset(AssetLoader& loader, Asset& asset);
+
+static void runFollowUp(AssetLoader& loader, AssetFollowUp& followUp) {
+    followUp.asset->failed = !followUp.build();
+    finishAsset(loader, *followUp.asset);
+}
+
+// Follow-ups whose last input just finished run inline on this worker.
+static void finishAsset(AssetLoader& loader, Asset& asset) {
+    vector<shared_ptr<AssetFollowUp>> runnable;
+    {
+        lock_guard<mutex> guard(loader.lock);
+        asset.ready.store(true, memory_order_release);
+        for (auto& followUp : asset.followUps) {
+            if (--followUp->waiting == 0) runnable.push_back(followUp);
+        }
+        asset.followUps.clear();
+    }
+
+    if (loader.readyEvent != (Uint32)-1) {
+        SDL_Event event;
+        SDL_zero(event);
+        event.type = loader.readyEvent;
+        SDL_PushEvent(&event);
+    }
+
+    for (auto& followUp : runnable) runFollowUp(loader, *followUp);
+}
+
+// Bundled assets are read in place from the mapping; anything else falls back
+// to a file under one of the search directories.
+static SDL_RWops* openAsset(const AssetLoader& loader, const Asset& asset) {
+    const char* data = nullptr;
+    size_t size = 0;
+    if (loader.bundle != nullptr && findBundleAsset(*loader.bundle, asset.name.c_str(), data, size)) {
+        return SDL_RWFromConstMem(data, (int)size);
+    }
+    for (const string& dir : loader.searchDirs) {
+        SDL_RWops* file = SDL_RWFromFile((dir + asset.name).c_str(), "rb");
+        if (file != nullptr) return file;
+    }
+    cerr << "Khong tim thay tai nguyen " << asset.name << "!" << endl;
+    return nullptr;
+}
+
+static void decodeAsset(AssetLoader& loader, Asset& asset) {
+    SDL_RWops* source = asset.kind == ASSET_DERIVED ? nullptr : openAsset(loader, asset);
+    switch (asset.kind) {
+        case ASSET_IMAGE:
+            if (source != nullptr) asset.surface = IMG_Load_RW(source, 1);
+            if (source != nullptr && asset.surface == nullptr) {
+                cerr << "Khong the tai hinh anh " << asset.name << "! SDL_image Error: " << IMG_GetError() << endl;
+            }
+            asset.failed = asset.surface == nullptr;
+            break;
+        case ASSET_SOUND:
+            if (source != nullptr) asset.chunk = Mix_LoadWAV_RW(source, 1);
+            if (source != nullptr && asset.chunk == nullptr) {
+                cerr << "Khong tai duoc am thanh! SDL_mixer Error: " << Mix_GetError() << endl;
+            }
+            asset.failed = asset.chunk == nullptr;
+            break;
+        case ASSET_MUSIC:
+            if (source != nullptr) asset.music = Mix_LoadMUS_RW(source, 1);
+            if (source != nullptr && asset.music == nullptr) {
+                cerr << "Khong tai duoc nhac nen! SDL_mixer Error: " << Mix_GetError() << endl;
+            }
+            asset.failed = asset.music == nullptr;
+            break;
+        case ASSET_FONT:
+            if (source != nullptr) {
+                lock_guard<mutex> guard(loader.ttfLock);
+                asset.font = TTF_OpenFontRW(source, 1, asset.fontSize);
+                if (asset.font == nullptr) {
+                    cerr << "Khong tai duoc font " << asset.name << "! SDL_ttf Error: " << TTF_GetError() << endl;
+                }
+            }
+            asset.failed = asset.font == nullptr;
+            break;
+        case ASSET_DERIVED:
+            break;
+    }
+    finishAsset(loader, asset);
+}
+
+void startAssetLoader(AssetLoader& loader, int threadCount, const AssetBundle* bundle,
+                      const vector<string>& searchDirs) {
+    loader.bundle = bundle;
+    loader.searchDirs = searchDirs;
+    loader.readyEvent = SDL_RegisterEvents(1);
+    startThreadPool(loader.pool, threadCount);
+    loader.started = true;
+}
+
+static Asset* requestAsset(AssetLoader& loader, AssetKind kind, const string& name, int fontSize) {
+    auto key = make_tuple((int)kind, name, fontSize);
+    Asset* asset;
+    {
+        lock_guard<mutex> guard(loader.lock);
+        auto found = loader.byKey.find(key);
+        if (found != loader.byKey.end()) return found->second;
+
+        loader.assets.emplace_back(new Asset());
+        asset = loader.assets.back().get();
+        asset->kind = kind;
+        asset->name = name;
+        asset->fontSize = fontSize;
+        loader.byKey[key] = asset;
+    }
+    submitTask(loader.pool, [&loader, asset](int) { decodeAsset(loader, *asset); });
+    return asset;
+}
+
+Asset* requestImage(AssetLoader& loader, const string& name) {
+    return requestAsset(loader, ASSET_IMAGE, name, 0);
+}
+
+Asset* requestSound(AssetLoader& loader, const string& name) {
+    return requestAsset(loader, ASSET_SOUND, name, 0);
+}
+
+Asset* requestMusic(AssetLoader& loader, const string& name) {
+    return requestAsset(loader, ASSET_MUSIC, name, 0);
+}
+
+Asset* requestFont(AssetLoader& loader, const string& name, int size) {
+    return requestAsset(loader, ASSET_FONT, name, size);
+}
+
+Asset* requestDerived(AssetLoader& loader, const vector<Asset*>& inputs, function<bool()> build) {
+    auto followUp = make_shared<AssetFollowUp>();
+    followUp->build = move(build);
+    followUp->waiting = 0;
+    {
+        lock_guard<mutex> guard(loader.lock);
+        loader.assets.emplace_back(new Asset());
+        followUp->asset = loader.assets.back().get();
+        followUp->asset->kind = ASSET_DERIVED;
+        for (Asset* input : inputs) {
+            if (input->ready.load(memory_order_acquire)) continue;
+            input->followUps.push_back(followUp);
+            followUp->waiting++;
+        }
+    }
+    if (followUp->waiting == 0) {
+        submitTask(loader.pool, [&loader, followUp](int) { runFollowUp(loader, *followUp); });
+    }
+    return followUp->asset;
+}
+
+bool assetsPending(AssetLoader& loader) {
+    lock_guard<mutex> guard(loader.lock);
+    for (auto& asset : loader.assets) {
+        if (!asset->ready.load(memory_order_acquire)) return true;
+    }
+    return false;
+}
+
+void freeAssets(AssetLoader& loader) {
+    if (loader.started) {
+        waitThreadPool(loader.pool);
+        stopThreadPool(loader.pool);
+        loader.started = false;
+    }
+    for (auto& asset : loader.assets) {
+        SDL_FreeSurface(asset->surface);
+        Mix_FreeChunk(asset->chunk);
+        Mix_FreeMusic(asset->music);
+        if (asset->font != nullptr) TTF_CloseFont(asset->font);
+    }
+    loader.assets.clear();
+    loader.byKey.clear();
+}
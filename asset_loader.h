@@ -0,0 +1,74 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <SDL_ttf.h>
+#include "asset_bundle.h"
+#include "thread_pool.h"
+
+enum AssetKind {
+    ASSET_IMAGE,
+    ASSET_SOUND,
+    ASSET_MUSIC,
+    ASSET_FONT,
+    ASSET_DERIVED
+};
+
+struct AssetFollowUp;
+
+// Decoded on a worker; the render thread reads the payload only once `ready`
+// is set. Images stay surfaces: the texture upload belongs to the render thread.
+struct Asset {
+    AssetKind kind = ASSET_IMAGE;
+    std::string name;
+    int fontSize = 0;
+    std::atomic<bool> ready{false};
+    bool failed = false;
+    SDL_Surface* surface = nullptr;
+    Mix_Chunk* chunk = nullptr;
+    Mix_Music* music = nullptr;
+    TTF_Font* font = nullptr;
+    std::vector<std::shared_ptr<AssetFollowUp>> followUps;
+};
+
+// Requests with the same kind, name and size share one Asset, so a file that
+// is used for two sounds is decoded once. Names are looked up in the bundle
+// first and then as files under each of `searchDirs`.
+struct AssetLoader {
+    ThreadPool pool;
+    const AssetBundle* bundle = nullptr;
+    std::vector<std::string> searchDirs;
+    std::vector<std::unique_ptr<Asset>> assets;
+    std::map<std::tuple<int, std::string, int>, Asset*> byKey;
+    std::mutex lock;
+    // SDL_ttf shares one FreeType library between fonts.
+    std::mutex ttfLock;
+    Uint32 readyEvent = 0;
+    bool started = false;
+};
+
+// Every finished asset pushes a `readyEvent` so a loop blocked in
+// SDL_WaitEvent wakes up to collect it. `bundle` may be null; if not, it must
+// stay open until freeAssets, since music and fonts keep reading from it.
+void startAssetLoader(AssetLoader& loader, int threadCount, const AssetBundle* bundle,
+                      const std::vector<std::string>& searchDirs);
+Asset* requestImage(AssetLoader& loader, const std::string& name);
+Asset* requestSound(AssetLoader& loader, const std::string& name);
+Asset* requestMusic(AssetLoader& loader, const std::string& name);
+Asset* requestFont(AssetLoader& loader, const std::string& name, int size);
+// Runs `build` on a worker once all of `inputs` are ready, even if some failed.
+Asset* requestDerived(AssetLoader& loader, const std::vector<Asset*>& inputs, std::function<bool()> build);
+bool assetsPending(AssetLoader& loader);
+// Waits for running decodes and frees everything that was loaded.
+void freeAssets(AssetLoader& loader);
+
+#endif
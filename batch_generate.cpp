@@ -0,0 +1,238 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "board_simd.h"
+#include "canonical.h"
+#include "generator.h"
+#include "puzzle_io.h"
+#include "solver.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+
+const long long CHUNK_SIZE = 256;
+
+static void printUsage(const char* program) {
+    cerr << "Cach dung: " << program << " -n SO_LUONG [-d easy|medium|hard] [-y none|rotational|mirror]"
+         << " [-g 4|9|16|25] [-s SEED] [-j LUONG] [-u] [-o FILE]" << endl;
+    cerr << "-u: bo cac de dang cau (chi voi -g 9), tao them cho du SO_LUONG de" << endl;
+}
+
+// Each puzzle has its own seed, derived only from the master seed and its
+// index, so the output does not change with the number of threads and any
+// single puzzle can be regenerated on its own.
+static uint64_t puzzleSeed(uint64_t masterSeed, long long index) {
+    return splitMix64(masterSeed ^ splitMix64((uint64_t)index));
+}
+
+struct ChunkStats {
+    long long invalid;
+    long long rating;
+    long long outOfBand;
+};
+
+// 9x9 puzzles go through the grader so they land in the rating band. With a
+// dedup table each puzzle's canonical fingerprint is claimed and kept.
+static void generateRatedChunk(Difficulty difficulty, HoleSymmetry symmetry, uint64_t masterSeed,
+                               long long first, long long end, string& text, ChunkStats& stats,
+                               DedupTable* dedup, vector<uint64_t>& fingerprints) {
+    Board solution;
+    Board puzzle;
+    GradeResult grade;
+    RatingBand band = ratingBandFor(difficulty);
+    for (long long index = first; index < end; index++) {
+        generatePuzzleFromSeed(puzzleSeed(masterSeed, index), difficulty, symmetry, solution, puzzle, &grade);
+        if (!isBoardSolved(solution) || !isBoardConsistent(puzzle)) stats.invalid++;
+        stats.rating += grade.rating;
+        if (grade.rating < band.minRating || grade.rating > band.maxRating) stats.outOfBand++;
+        appendPuzzleLine(text, puzzle);
+        if (dedup != nullptr) {
+            uint64_t fingerprint = canonicalFingerprint(puzzle.cells);
+            fingerprints.push_back(fingerprint);
+            if (!claimFingerprint(*dedup, fingerprint, (uint64_t)index)) stats.invalid++;
+        }
+    }
+}
+
+// Other sizes have no grader; the mask solver checks the boards instead.
+template <int BOX>
+static void generateSizedChunk(Difficulty difficulty, HoleSymmetry symmetry, uint64_t masterSeed,
+                               long long first, long long end, string& text, ChunkStats& stats) {
+    BasicBoard<BOX> solution;
+    BasicBoard<BOX> puzzle;
+    BasicMaskSolver<BOX> check;
+    Rng rng;
+    for (long long index = first; index < end; index++) {
+        seedRng(rng, puzzleSeed(masterSeed, index));
+        generateSizedPuzzle(difficulty, symmetry, rng, solution, puzzle);
+        if (!initMaskSolver(check, solution) || check.emptyCount != 0 || !initMaskSolver(check, puzzle)) {
+            stats.invalid++;
+        }
+        appendPuzzleLine(text, puzzle);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long long count = -1;
+    Difficulty difficulty = MEDIUM;
+    HoleSymmetry symmetry = SYMMETRY_ROTATIONAL;
+    uint64_t masterSeed = ((uint64_t)random_device{}() << 32) | random_device{}();
+    int threadCount = defaultThreadCount();
+    int gridSize = GRID_SIZE;
+    const char* outputPath = nullptr;
+    bool dedupe = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-u") == 0) {
+            dedupe = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (strcmp(argv[i - 1], "-n") == 0) {
+            count = strtoll(value, nullptr, 10);
+        } else if (strcmp(argv[i - 1], "-d") == 0) {
+            if (strcmp(value, "easy") == 0) difficulty = EASY;
+            else if (strcmp(value, "hard") == 0) difficulty = HARD;
+            else difficulty = MEDIUM;
+        } else if (strcmp(argv[i - 1], "-y") == 0) {
+            if (strcmp(value, "none") == 0) symmetry = SYMMETRY_NONE;
+            else if (strcmp(value, "mirror") == 0) symmetry = SYMMETRY_MIRROR;
+            else symmetry = SYMMETRY_ROTATIONAL;
+        } else if (strcmp(argv[i - 1], "-g") == 0) {
+            gridSize = atoi(value);
+        } else if (strcmp(argv[i - 1], "-s") == 0) {
+            masterSeed = strtoull(value, nullptr, 10);
+        } else if (strcmp(argv[i - 1], "-j") == 0) {
+            threadCount = atoi(value);
+        } else if (strcmp(argv[i - 1], "-o") == 0) {
+            outputPath = value;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (count < 0 || threadCount < 1
+        || (gridSize != 4 && gridSize != 9 && gridSize != 16 && gridSize != 25)
+        || (dedupe && gridSize != GRID_SIZE)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (outputPath != nullptr) {
+        out = fopen(outputPath, "wb");
+        if (out == nullptr) {
+            cerr << "Khong mo duoc file " << outputPath << "!" << endl;
+            return 1;
+        }
+    }
+
+    ThreadPool pool;
+    startThreadPool(pool, threadCount);
+
+    // Chunks are generated a window at a time and written in order, which
+    // keeps memory bounded and the output deterministic. With -u a window
+    // may drop duplicates, so generation runs past `count` until enough
+    // unique puzzles are out.
+    long long chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    long long window = (long long)threadCount * 4;
+    vector<string> buffers(window);
+    vector<vector<uint64_t>> fingerprints(window);
+    atomic<long long> invalidBoards{0};
+    atomic<long long> ratingTotal{0};
+    atomic<long long> outOfBand{0};
+    RatingBand band = ratingBandFor(difficulty);
+    DedupTable dedup;
+    if (dedupe) initDedupTable(dedup, (size_t)(count + window * CHUNK_SIZE));
+    long long generated = 0;
+    long long written = 0;
+    const size_t lineLength = PUZZLE_LINE_LENGTH + 1;
+
+    auto startTime = chrono::steady_clock::now();
+    long long duplicates = 0;
+    for (long long first = 0, last = 0; dedupe ? written < count : first < chunkCount; first = last) {
+        long long wanted = dedupe ? (count - written + CHUNK_SIZE - 1) / CHUNK_SIZE : chunkCount - first;
+        last = first + min(window, wanted);
+        for (long long chunk = first; chunk < last; chunk++) {
+            submitTask(pool, [&, chunk, first](int) {
+                string& text = buffers[chunk - first];
+                vector<uint64_t>& chunkFingerprints = fingerprints[chunk - first];
+                text.clear();
+                chunkFingerprints.clear();
+                ChunkStats stats = {};
+                long long begin = chunk * CHUNK_SIZE;
+                long long end = dedupe ? begin + CHUNK_SIZE : min(begin + CHUNK_SIZE, count);
+                switch (gridSize) {
+                    case 4:
+                        generateSizedChunk<2>(difficulty, symmetry, masterSeed, begin, end, text, stats);
+                        break;
+                    case 16:
+                        generateSizedChunk<4>(difficulty, symmetry, masterSeed, begin, end, text, stats);
+                        break;
+                    case 25:
+                        generateSizedChunk<5>(difficulty, symmetry, masterSeed, begin, end, text, stats);
+                        break;
+                    default:
+                        generateRatedChunk(difficulty, symmetry, masterSeed, begin, end, text, stats,
+                                           dedupe ? &dedup : nullptr, chunkFingerprints);
+                        break;
+                }
+                invalidBoards += stats.invalid;
+                ratingTotal += stats.rating;
+                outOfBand += stats.outOfBand;
+            });
+        }
+        waitThreadPool(pool);
+
+        for (long long chunk = first; chunk < last; chunk++) {
+            const string& text = buffers[chunk - first];
+            if (!dedupe) {
+                fwrite(text.data(), 1, text.size(), out);
+                generated += min(CHUNK_SIZE, count - chunk * CHUNK_SIZE);
+                continue;
+            }
+            const vector<uint64_t>& chunkFingerprints = fingerprints[chunk - first];
+            generated += chunkFingerprints.size();
+            for (size_t line = 0; line < chunkFingerprints.size() && written < count; line++) {
+                uint64_t index = (uint64_t)(chunk * CHUNK_SIZE) + line;
+                if (!isFirstOccurrence(dedup, chunkFingerprints[line], index)) {
+                    duplicates++;
+                    continue;
+                }
+                fwrite(text.data() + line * lineLength, 1, lineLength, out);
+                written++;
+            }
+        }
+    }
+    stopThreadPool(pool);
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    if (out != stdout) fclose(out);
+    else fflush(out);
+
+    cerr << "Da tao " << count << " de trong " << seconds << " s ("
+         << (seconds > 0 ? count / seconds : 0) << " de/s), seed " << masterSeed << endl;
+    if (dedupe) {
+        cerr << "Da bo " << duplicates << " de dang cau trong " << generated << " de da tao" << endl;
+    }
+    if (generated > 0 && gridSize == GRID_SIZE) {
+        cerr << "Do kho trung binh " << ratingTotal / (double)generated / 10 << " (khoang " << band.minRating / 10.0
+             << " - " << band.maxRating / 10.0 << ", " << outOfBand << " de nam ngoai khoang)" << endl;
+    }
+    if (invalidBoards > 0) {
+        cerr << "Co " << invalidBoards << " bang khong hop le!" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "puzzle_file.h"
+#include "puzzle_io.h"
+#include "solver.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+
+const int CHUNK_LINES = 1024;
+
+struct ChunkStats {
+    long long puzzles = 0;
+    long long invalid = 0;
+    long long unsolvable = 0;
+    long long unique = 0;
+    long long multiple = 0;
+    double totalMicros = 0;
+    double maxMicros = 0;
+};
+
+static void printUsage(const char* program) {
+    cerr << "Cach dung: " << program << " [-j LUONG] [-c GIOI_HAN_DEM] [-o FILE] [-q] FILE|-" << endl;
+}
+
+struct BatchContext {
+    int countLimit = 2;
+    bool quiet = false;
+    FILE* out = stdout;
+    vector<string> outputs;
+    vector<ChunkStats> chunkStats;
+    ChunkStats total;
+};
+
+// Solves straight from the line text into a MaskSolver, with no per-line
+// allocation. LineAt(index, text, length) returns false for a broken line.
+template <typename LineAt>
+static void solveChunk(const LineAt& lineAt, size_t begin, size_t end, int countLimit,
+                       bool quiet, string& out, ChunkStats& stats) {
+    uint8_t cells[PUZZLE_LINE_LENGTH];
+    MaskSolver solver;
+    char timeText[32];
+
+    for (size_t i = begin; i < end; i++) {
+        const char* text = nullptr;
+        size_t length = 0;
+        stats.puzzles++;
+        if (!lineAt(i, text, length) || !parsePuzzleCells(text, length, cells)) {
+            stats.invalid++;
+            if (!quiet) out += "- invalid 0\n";
+            continue;
+        }
+
+        auto start = chrono::steady_clock::now();
+        int count = 0;
+        bool solved = false;
+        if (initMaskSolverFromCells(solver, cells)) {
+            count = countSolutionsMasked(solver, countLimit);
+            solved = count > 0 && solveMasked(solver, nullptr);
+        }
+        double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+        stats.totalMicros += micros;
+        if (micros > stats.maxMicros) stats.maxMicros = micros;
+        if (count == 0) stats.unsolvable++;
+        else if (count == 1) stats.unique++;
+        else stats.multiple++;
+
+        if (quiet) continue;
+        if (solved) {
+            appendPuzzleCells(out, solver.cells);
+        } else {
+            out += '-';
+        }
+        snprintf(timeText, sizeof(timeText), " %d %.1f\n", count, micros);
+        out += timeText;
+    }
+}
+
+// Solves lines [begin, end) as chunks on the pool, then writes them in order.
+template <typename LineAt>
+static void solveWindow(ThreadPool& pool, BatchContext& context, const LineAt& lineAt, size_t begin, size_t end) {
+    size_t chunkCount = (end - begin + CHUNK_LINES - 1) / CHUNK_LINES;
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        submitTask(pool, [&context, &lineAt, chunk, begin, end](int) {
+            size_t first = begin + chunk * CHUNK_LINES;
+            size_t last = min(first + CHUNK_LINES, end);
+            context.outputs[chunk].clear();
+            context.chunkStats[chunk] = ChunkStats();
+            solveChunk(lineAt, first, last, context.countLimit, context.quiet,
+                       context.outputs[chunk], context.chunkStats[chunk]);
+        });
+    }
+    waitThreadPool(pool);
+
+    ChunkStats& total = context.total;
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        fwrite(context.outputs[chunk].data(), 1, context.outputs[chunk].size(), context.out);
+        const ChunkStats& stats = context.chunkStats[chunk];
+        total.puzzles += stats.puzzles;
+        total.invalid += stats.invalid;
+        total.unsolvable += stats.unsolvable;
+        total.unique += stats.unique;
+        total.multiple += stats.multiple;
+        total.totalMicros += stats.totalMicros;
+        if (stats.maxMicros > total.maxMicros) total.maxMicros = stats.maxMicros;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int threadCount = defaultThreadCount();
+    BatchContext context;
+    const char* inputPath = nullptr;
+    const char* outputPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0) {
+            context.quiet = true;
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            context.countLimit = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (inputPath == nullptr) {
+            inputPath = argv[i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (inputPath == nullptr || threadCount < 1 || context.countLimit < 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (outputPath != nullptr) {
+        context.out = fopen(outputPath, "wb");
+        if (context.out == nullptr) {
+            cerr << "Khong mo duoc file " << outputPath << "!" << endl;
+            return 1;
+        }
+    }
+
+    ThreadPool pool;
+    startThreadPool(pool, threadCount);
+
+    size_t window = (size_t)threadCount * 4;
+    context.outputs.resize(window);
+    context.chunkStats.resize(window);
+    size_t windowLines = window * CHUNK_LINES;
+
+    auto startTime = chrono::steady_clock::now();
+    MappedPuzzleFile mapped;
+    if (strcmp(inputPath, "-") != 0 && openPuzzleFile(mapped, inputPath)) {
+        auto lineAt = [&mapped](size_t index, const char*& text, size_t& length) {
+            text = puzzleAt(mapped, index);
+            length = mapped.lineLength;
+            return puzzleLineIntact(mapped, index);
+        };
+        for (size_t begin = 0; begin < mapped.count; begin += windowLines) {
+            solveWindow(pool, context, lineAt, begin, min(begin + windowLines, mapped.count));
+        }
+        closePuzzleFile(mapped);
+    } else {
+        ifstream file;
+        if (strcmp(inputPath, "-") != 0) {
+            file.open(inputPath, ios::binary);
+            if (!file) {
+                cerr << "Khong mo duoc file " << inputPath << "!" << endl;
+                stopThreadPool(pool);
+                return 1;
+            }
+        }
+        istream& in = file.is_open() ? file : cin;
+
+        vector<string> lines(windowLines);
+        auto lineAt = [&lines](size_t index, const char*& text, size_t& length) {
+            text = lines[index].data();
+            length = lines[index].size();
+            return true;
+        };
+        while (in) {
+            size_t lineCount = 0;
+            while (lineCount < lines.size() && getline(in, lines[lineCount])) {
+                if (!lines[lineCount].empty() && lines[lineCount].back() == '\r') lines[lineCount].pop_back();
+                if (lines[lineCount].empty() || lines[lineCount][0] == '#') continue;
+                lineCount++;
+            }
+            if (lineCount == 0) break;
+            solveWindow(pool, context, lineAt, 0, lineCount);
+        }
+    }
+    stopThreadPool(pool);
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    if (context.out != stdout) fclose(context.out);
+    else fflush(context.out);
+
+    const ChunkStats& total = context.total;
+    long long solvedCount = total.puzzles - total.invalid;
+    cerr << "So de: " << total.puzzles << " (duy nhat " << total.unique << ", nhieu loi giai " << total.multiple
+         << ", vo nghiem " << total.unsolvable << ", sai dinh dang " << total.invalid << ")" << endl;
+    cerr << "Thoi gian: " << seconds << " s, " << (seconds > 0 ? total.puzzles / seconds : 0) << " de/s, "
+         << "trung binh " << (solvedCount > 0 ? total.totalMicros / solvedCount : 0) << " us/de, "
+         << "lau nhat " << total.maxMicros << " us" << endl;
+    return 0;
+}
@@ -0,0 +1,417 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include "asset_bundle.h"
+#include "board_render.h"
+#include "board_state.h"
+#include "dlx.h"
+#include "generator.h"
+#include "puzzle_io.h"
+#include "solver.h"
+#include "text_cache.h"
+
+using namespace std;
+
+
+const uint64_t DEFAULT_SEED = 20240601;
+const int DEFAULT_PUZZLES = 200;
+const int DEFAULT_FRAMES = 500;
+const double MIN_SECTION_SECONDS = 0.5;
+// The reference backtracker needs tens of seconds for some 17-clue puzzles,
+// so every solver stops starting new puzzles once this much time has passed.
+const double MAX_SECTION_SECONDS = 5.0;
+const char* const BENCH_BUNDLE_PATH = "assets.pak";
+
+// Well-known hard puzzles: AI Escargot, Easter Monster, Inkala 2012 and
+// five 17-clue puzzles, all with a unique solution.
+const char* const CLASSIC_HARD[] = {
+    "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..",
+    "1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1",
+    "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+    "4.....8.5.3..........7......2.....6.....8.4......1.......6.3.7.5..2.....1.4......",
+    "52...6.........7.13...........4..8..6......5...........418.........3..2...87.....",
+    "6.....8.3.4.7.................5.4.7.3..2.....1.6.......2.....5.....8.6......1....",
+    "48.3............71.2.......7.5....6....2..8.............1.76...3.....4......5....",
+    "....14....3....2...7..........9...3.6.1.............8.2.....1.4....5.6.....7.8...",
+};
+
+struct Corpus {
+    string name;
+    vector<Board> puzzles;
+};
+
+struct SolverResult {
+    string solver;
+    string corpus;
+    long long solved;
+    long long failed;
+    double seconds;
+    bool complete;
+};
+
+struct LatencyResult {
+    string name;
+    vector<double> micros;
+};
+
+struct RenderResult {
+    bool available;
+    bool fonts;
+    double cellContentsNs;
+    double frameDirectUs;
+    double frameLayersIdleUs;
+    double frameLayersEditUs;
+};
+
+typedef chrono::steady_clock BenchClock;
+
+static double secondsSince(BenchClock::time_point start) {
+    return chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+static void printUsage(const char* program) {
+    cerr << "Cach dung: " << program << " [-s SEED] [-n SO_DE] [-f FILE_DE] [-r SO_KHUNG_HINH] [-o FILE.json]" << endl;
+}
+
+static Corpus generatedCorpus(uint64_t seed, int count) {
+    Corpus corpus;
+    corpus.name = "generated-hard";
+    Board solution;
+    Board puzzle;
+    for (int i = 0; i < count; i++) {
+        generatePuzzleFromSeed(splitMix64(seed + i), HARD, SYMMETRY_ROTATIONAL, solution, puzzle);
+        corpus.puzzles.push_back(puzzle);
+    }
+    return corpus;
+}
+
+static Corpus classicCorpus() {
+    Corpus corpus;
+    corpus.name = "classic-hard";
+    for (const char* line : CLASSIC_HARD) {
+        Board board;
+        if (parsePuzzleLine(line, strlen(line), board)) corpus.puzzles.push_back(board);
+    }
+    return corpus;
+}
+
+static bool fileCorpus(const char* path, Corpus& corpus) {
+    ifstream file(path);
+    if (!file) {
+        cerr << "Khong mo duoc file " << path << "!" << endl;
+        return false;
+    }
+
+    corpus.name = path;
+    string line;
+    while (getline(file, line)) {
+        Board board;
+        if (parsePuzzleLine(line.data(), line.size(), board)) corpus.puzzles.push_back(board);
+    }
+    return true;
+}
+
+// Passes over the corpus until MIN_SECTION_SECONDS have gone by, but never
+// starts a puzzle after MAX_SECTION_SECONDS.
+static SolverResult benchSolver(const string& name, const Corpus& corpus, const function<bool(Board&)>& solve) {
+    SolverResult result = {name, corpus.name, 0, 0, 0, true};
+    if (corpus.puzzles.empty()) return result;
+
+    auto start = BenchClock::now();
+    do {
+        for (const Board& puzzle : corpus.puzzles) {
+            if (secondsSince(start) > MAX_SECTION_SECONDS) {
+                result.complete = false;
+                break;
+            }
+            Board board = puzzle;
+            if (solve(board)) result.solved++;
+            else result.failed++;
+        }
+    } while (result.complete && secondsSince(start) < MIN_SECTION_SECONDS);
+    result.seconds = secondsSince(start);
+    return result;
+}
+
+static vector<SolverResult> benchSolvers(const vector<Corpus>& corpora, uint64_t seed) {
+    vector<SolverResult> results;
+    DlxSolver* dlx = new DlxSolver;
+    initDlx(*dlx);
+    Rng rng;
+    seedRng(rng, seed);
+
+    for (const Corpus& corpus : corpora) {
+        results.push_back(benchSolver("solveSudoku", corpus, [&rng](Board& board) {
+            return solveSudoku(board, rng);
+        }));
+        results.push_back(benchSolver("solveSudokuFast", corpus, [](Board& board) {
+            return solveSudokuFast(board);
+        }));
+        results.push_back(benchSolver("dlxSolve", corpus, [dlx](Board& board) {
+            return dlxSolve(*dlx, board);
+        }));
+    }
+    delete dlx;
+    return results;
+}
+
+static LatencyResult timeSamples(const string& name, int samples, const function<void(int)>& run) {
+    LatencyResult result;
+    result.name = name;
+    for (int i = 0; i < samples; i++) {
+        auto start = BenchClock::now();
+        run(i);
+        result.micros.push_back(secondsSince(start) * 1e6);
+    }
+    sort(result.micros.begin(), result.micros.end());
+    return result;
+}
+
+// buildSudoku is the solution fill alone; generatePuzzle is what resetGame
+// falls back to when the pool is empty, fill and rated carving together.
+static vector<LatencyResult> benchGenerator(uint64_t seed, int samples) {
+    vector<LatencyResult> results;
+    Board solution;
+    Board puzzle;
+
+    results.push_back(timeSamples("buildSudoku", samples, [&](int i) {
+        Rng rng;
+        seedRng(rng, splitMix64(seed ^ i));
+        buildSudoku(solution, rng);
+    }));
+
+    const char* names[DIFFICULTY_COUNT] = {"generatePuzzle/easy", "generatePuzzle/medium", "generatePuzzle/hard"};
+    for (int level = 0; level < DIFFICULTY_COUNT; level++) {
+        results.push_back(timeSamples(names[level], samples, [&](int i) {
+            generatePuzzleFromSeed(splitMix64(seed + i), (Difficulty)level, SYMMETRY_ROTATIONAL, solution, puzzle);
+        }));
+    }
+    return results;
+}
+
+static TTF_Font* openBenchFont(const AssetBundle& bundle, const char* name, int size) {
+    const char* data;
+    size_t length;
+    if (findBundleAsset(bundle, name, data, length)) {
+        return TTF_OpenFontRW(SDL_RWFromConstMem(data, (int)length), 1, size);
+    }
+    for (const char* dir : {"", "C:\\Windows\\Fonts\\"}) {
+        TTF_Font* font = TTF_OpenFont((string(dir) + name).c_str(), size);
+        if (font != nullptr) return font;
+    }
+    return nullptr;
+}
+
+template <typename Draw>
+static double averageMicros(int frames, Draw draw) {
+    auto start = BenchClock::now();
+    for (int i = 0; i < frames; i++) draw(i);
+    return secondsSince(start) * 1e6 / frames;
+}
+
+// Renders into a plain surface with SDL's software renderer, so no display
+// or GPU is involved. The board is a hard puzzle part way through, with a
+// few pencil marks.
+static RenderResult benchRender(uint64_t seed, int frames) {
+    RenderResult result = {false, false, 0, 0, 0, 0};
+    if (SDL_Init(0) < 0 || TTF_Init() == -1) {
+        cerr << "SDL khong the khoi tao! SDL_Error: " << SDL_GetError() << endl;
+        return result;
+    }
+
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = target != nullptr ? SDL_CreateSoftwareRenderer(target) : nullptr;
+    if (renderer == nullptr) {
+        cerr << "Renderer khong the tao! SDL_Error: " << SDL_GetError() << endl;
+        SDL_FreeSurface(target);
+        TTF_Quit();
+        SDL_Quit();
+        return result;
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    result.available = true;
+
+    AssetBundle bundle;
+    openAssetBundle(bundle, BENCH_BUNDLE_PATH);
+    TTF_Font* font = openBenchFont(bundle, "Arialbd.ttf", 36);
+    TTF_Font* fontSmall = openBenchFont(bundle, "Arial.ttf", 18);
+    result.fonts = font != nullptr && fontSmall != nullptr && initTextCache(renderer, font, fontSmall);
+    if (!result.fonts) cerr << "Khong tai duoc font, do thoi gian ve khong co chu." << endl;
+
+    Board solution;
+    Board board;
+    generatePuzzleFromSeed(seed, HARD, SYMMETRY_ROTATIONAL, solution, board);
+    BoardState state;
+    initBoardState(state, board);
+    for (int cell = 0; cell < BOARD_CELLS; cell += 3) {
+        if (board.cells[cell] == 0) placeDigit(state, board, cell, solution.cells[cell]);
+    }
+    for (int cell = 1; cell < BOARD_CELLS; cell += 7) {
+        if (board.cells[cell] == 0) {
+            togglePencilMark(state, cell, solution.cells[cell]);
+            togglePencilMark(state, cell, solution.cells[cell] % GRID_SIZE + 1);
+        }
+    }
+    int editCell = 0;
+    while (board.cells[editCell] != 0) editCell++;
+
+    auto drawHud = [&](int frame) {
+        drawRectangle(renderer, 0, 0, SCREEN_WIDTH, UI_AREA_HEIGHT, GRAY);
+        drawTimer(renderer, 1800 - frame % 1800);
+        drawTries(renderer, 5);
+    };
+
+    result.cellContentsNs = averageMicros(frames, [&](int) {
+        for (int row = 0; row < GRID_SIZE; row++) {
+            for (int col = 0; col < GRID_SIZE; col++) {
+                drawCellContents(renderer, board, state, row, col, GAME_AREA_Y_OFFSET);
+            }
+        }
+    }) * 1000 / BOARD_CELLS;
+
+    result.frameDirectUs = averageMicros(frames, [&](int frame) {
+        drawHud(frame);
+        drawBoardDirect(renderer, board, state, frame % BOARD_CELLS);
+    });
+
+    // The first frame fills the layers; the rest only composite them.
+    renderBoardLayers(renderer, board, state, 0);
+    result.frameLayersIdleUs = averageMicros(frames, [&](int frame) {
+        drawHud(frame);
+        renderBoardLayers(renderer, board, state, 0);
+    });
+
+    // One digit placed or cleared per frame, as during play.
+    result.frameLayersEditUs = averageMicros(frames, [&](int frame) {
+        drawHud(frame);
+        placeDigit(state, board, editCell, (frame & 1) ? 0 : solution.cells[editCell]);
+        renderBoardLayers(renderer, board, state, editCell);
+    });
+
+    freeBoardLayers();
+    freeTextCache();
+    if (font != nullptr) TTF_CloseFont(font);
+    if (fontSmall != nullptr) TTF_CloseFont(fontSmall);
+    closeAssetBundle(bundle);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+    TTF_Quit();
+    SDL_Quit();
+    return result;
+}
+
+static double percentile(const vector<double>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    size_t index = (size_t)(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+static string jsonString(const string& text) {
+    string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static void writeJson(FILE* out, uint64_t seed, const vector<SolverResult>& solvers,
+                      const vector<LatencyResult>& generator, const RenderResult& render) {
+    fprintf(out, "{\n  \"seed\": %llu,\n  \"solver\": [\n", (unsigned long long)seed);
+    for (size_t i = 0; i < solvers.size(); i++) {
+        const SolverResult& r = solvers[i];
+        fprintf(out, "    {\"name\": %s, \"corpus\": %s, \"solved\": %lld, \"failed\": %lld, "
+                     "\"seconds\": %.6f, \"solvesPerSecond\": %.1f, \"complete\": %s}%s\n",
+                jsonString(r.solver).c_str(), jsonString(r.corpus).c_str(), r.solved, r.failed, r.seconds,
+                r.seconds > 0 ? r.solved / r.seconds : 0.0, r.complete ? "true" : "false",
+                i + 1 < solvers.size() ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"generator\": [\n");
+    for (size_t i = 0; i < generator.size(); i++) {
+        const LatencyResult& r = generator[i];
+        fprintf(out, "    {\"name\": %s, \"samples\": %zu, \"p50Us\": %.1f, \"p90Us\": %.1f, "
+                     "\"p99Us\": %.1f, \"maxUs\": %.1f}%s\n",
+                jsonString(r.name).c_str(), r.micros.size(), percentile(r.micros, 0.5), percentile(r.micros, 0.9),
+                percentile(r.micros, 0.99), r.micros.empty() ? 0.0 : r.micros.back(),
+                i + 1 < generator.size() ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"render\": {\"available\": %s, \"fonts\": %s, \"drawCellContentsNs\": %.1f, "
+                 "\"frameDirectUs\": %.1f, \"frameLayersIdleUs\": %.1f, \"frameLayersEditUs\": %.1f}\n}\n",
+            render.available ? "true" : "false", render.fonts ? "true" : "false", render.cellContentsNs,
+            render.frameDirectUs, render.frameLayersIdleUs, render.frameLayersEditUs);
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t seed = DEFAULT_SEED;
+    int puzzles = DEFAULT_PUZZLES;
+    int frames = DEFAULT_FRAMES;
+    const char* corpusPath = nullptr;
+    const char* outputPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (strcmp(argv[i - 1], "-s") == 0) {
+            seed = strtoull(value, nullptr, 10);
+        } else if (strcmp(argv[i - 1], "-n") == 0) {
+            puzzles = atoi(value);
+        } else if (strcmp(argv[i - 1], "-f") == 0) {
+            corpusPath = value;
+        } else if (strcmp(argv[i - 1], "-r") == 0) {
+            frames = atoi(value);
+        } else if (strcmp(argv[i - 1], "-o") == 0) {
+            outputPath = value;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (puzzles < 1 || frames < 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    vector<Corpus> corpora;
+    corpora.push_back(generatedCorpus(seed, puzzles));
+    corpora.push_back(classicCorpus());
+    if (corpusPath != nullptr) {
+        Corpus corpus;
+        if (!fileCorpus(corpusPath, corpus)) return 1;
+        corpora.push_back(corpus);
+    }
+
+    vector<SolverResult> solvers = benchSolvers(corpora, seed);
+    vector<LatencyResult> generator = benchGenerator(seed, puzzles);
+    RenderResult render = benchRender(seed, frames);
+
+    FILE* out = stdout;
+    if (outputPath != nullptr) {
+        out = fopen(outputPath, "wb");
+        if (out == nullptr) {
+            cerr << "Khong mo duoc file " << outputPath << "!" << endl;
+            return 1;
+        }
+    }
+    writeJson(out, seed, solvers, generator, render);
+    if (out != stdout) fclose(out);
+
+    for (const SolverResult& r : solvers) {
+        if (r.failed > 0) {
+            cerr << r.solver << " khong giai duoc " << r.failed << " de trong " << r.corpus << "!" << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,9 @@
+#include "board.h"
+#include "board_simd.h"
+
+using namespace std;
+
+
+void refreshCandidates(Board& board) {
+    computeAllCandidates(board, board.candidates);
+}
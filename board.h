@@ -0,0 +1,106 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Everything sized by the board is derived from the box edge at compile
+// time: 2 gives 4x4, 3 the classic 9x9, 4 gives 16x16 and 5 gives 25x25.
+// Digit masks use the narrowest unsigned type with a bit per digit.
+template <int BOX>
+struct BoardGeometry {
+    static_assert(BOX >= 2 && BOX <= 5, "box edge must be 2..5");
+
+    static constexpr int BOX_SIZE = BOX;
+    static constexpr int SIZE = BOX * BOX;
+    static constexpr int CELLS = SIZE * SIZE;
+    static constexpr int GIVEN_WORDS = (CELLS + 63) / 64;
+
+    typedef typename std::conditional<SIZE <= 16, uint16_t, uint32_t>::type Mask;
+    typedef typename std::conditional<CELLS <= 256, uint8_t, uint16_t>::type CellIndex;
+
+    static constexpr Mask ALL_DIGITS = (Mask)(((uint64_t)1 << SIZE) - 1);
+};
+
+// Flat board. It is trivially copyable, so `a = b` is a single memcpy.
+// Bit d-1 of candidates[i] is set when digit d can still go into cell i.
+template <int BOX>
+struct BasicBoard {
+    typedef BoardGeometry<BOX> Geometry;
+    typedef typename Geometry::Mask Mask;
+
+    uint8_t cells[Geometry::CELLS];
+    uint64_t givenBits[Geometry::GIVEN_WORDS];
+    Mask candidates[Geometry::CELLS];
+
+    int get(int row, int col) const {
+        return cells[row * Geometry::SIZE + col];
+    }
+
+    void set(int row, int col, int value) {
+        cells[row * Geometry::SIZE + col] = (uint8_t)value;
+    }
+
+    bool isGiven(int row, int col) const {
+        int index = row * Geometry::SIZE + col;
+        return (givenBits[index >> 6] >> (index & 63)) & 1;
+    }
+
+    void setGiven(int row, int col, bool given) {
+        int index = row * Geometry::SIZE + col;
+        uint64_t bit = (uint64_t)1 << (index & 63);
+        if (given) givenBits[index >> 6] |= bit;
+        else givenBits[index >> 6] &= ~bit;
+    }
+
+    void clear() {
+        memset(this, 0, sizeof(BasicBoard));
+    }
+};
+
+// The game, the grader and the SIMD kernels work on the classic board.
+const int BOX_SIZE = 3;
+typedef BasicBoard<BOX_SIZE> Board;
+const int GRID_SIZE = Board::Geometry::SIZE;
+const int BOARD_CELLS = Board::Geometry::CELLS;
+
+template <int BOX>
+void markGivens(BasicBoard<BOX>& board) {
+    memset(board.givenBits, 0, sizeof(board.givenBits));
+    for (int row = 0; row < BOX * BOX; row++) {
+        for (int col = 0; col < BOX * BOX; col++) {
+            if (board.get(row, col) != 0) board.setGiven(row, col, true);
+        }
+    }
+}
+
+// Scalar version for any size; the 9x9 overload uses the SIMD kernels.
+template <int BOX>
+void refreshCandidates(BasicBoard<BOX>& board) {
+    typedef BoardGeometry<BOX> Geometry;
+    typename Geometry::Mask rows[Geometry::SIZE] = {};
+    typename Geometry::Mask cols[Geometry::SIZE] = {};
+    typename Geometry::Mask boxes[Geometry::SIZE] = {};
+
+    for (int cell = 0; cell < Geometry::CELLS; cell++) {
+        int value = board.cells[cell];
+        if (value == 0) continue;
+        int row = cell / Geometry::SIZE;
+        int col = cell % Geometry::SIZE;
+        typename Geometry::Mask bit = (typename Geometry::Mask)1 << (value - 1);
+        rows[row] |= bit;
+        cols[col] |= bit;
+        boxes[(row / BOX) * BOX + col / BOX] |= bit;
+    }
+    for (int cell = 0; cell < Geometry::CELLS; cell++) {
+        int row = cell / Geometry::SIZE;
+        int col = cell % Geometry::SIZE;
+        board.candidates[cell] = board.cells[cell] ? 0
+            : Geometry::ALL_DIGITS & ~(rows[row] | cols[col] | boxes[(row / BOX) * BOX + col / BOX]);
+    }
+}
+
+void refreshCandidates(Board& board);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef BOARD_LAYOUT_H
+#define BOARD_LAYOUT_H
+
+#include "board.h"
+
+// Screen geometry shared by the renderer and the hit tests in game_logic,
+// which has to work without SDL.
+const int GAME_AREA_SIZE = 630;
+const int UI_AREA_HEIGHT = 30;
+const int SCREEN_WIDTH = GAME_AREA_SIZE;
+const int SCREEN_HEIGHT = GAME_AREA_SIZE + UI_AREA_HEIGHT;
+const int CELL_SIZE = GAME_AREA_SIZE / GRID_SIZE;
+const int GAME_AREA_Y_OFFSET = UI_AREA_HEIGHT;
+
+// Pause menu items are centred, one per PAUSE_MENU_SPACING, and as tall as
+// the large font; without a font the default height is used.
+const int PAUSE_MENU_Y = SCREEN_HEIGHT / 3;
+const int PAUSE_MENU_SPACING = 60;
+const int PAUSE_MENU_WIDTH = 200;
+const int DEFAULT_MENU_ITEM_HEIGHT = 42;
+
+#endif
@@ -0,0 +1,271 @@
+#include "board_render.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include "perf_trace.h"
+#include "text_cache.h"
+
+using namespace std;
+
+
+// The grid layer caches the background and grid lines; the cell layer holds the
+// selection, numbers and pencil marks and only redraws cells that changed since
+// `shown`. Nothing is compared while the board version and selection stay put.
+struct BoardLayers {
+    SDL_Texture* grid = nullptr;
+    SDL_Texture* cells = nullptr;
+    Board shown;
+    uint16_t shownPencil[BOARD_CELLS];
+    uint64_t shownConflicts[2];
+    unsigned shownVersion = 0;
+    int shownSelected = -1;
+    bool gridValid = false;
+    bool cellsValid = false;
+    bool unsupported = false;
+};
+static BoardLayers gLayers;
+static SDL_Texture* gBackground = nullptr;
+
+
+void drawLine(SDL_Renderer* renderer, int x1, int y1, int x2, int y2, int width) {
+    SDL_SetRenderDrawColor(renderer, BLACK.r, BLACK.g, BLACK.b, BLACK.a);
+
+
+    int dx = (x1 == x2) ? 1 : 0;
+    int dy = (y1 == y2) ? 1 : 0;
+
+    for (int i = -width / 2; i < (width + 1) / 2; ++i) {
+        SDL_RenderDrawLine(renderer, x1 + i * dx, y1 + i * dy, x2 + i * dx, y2 + i * dy);
+    }
+}
+
+void drawRectangle(SDL_Renderer* renderer, int x, int y, int w, int h, SDL_Color color) {
+    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+    SDL_Rect rect = {x, y, w, h};
+    SDL_RenderFillRect(renderer, &rect);
+}
+
+// An empty cell shows its pencil marks on a 3x3 grid, digit d in slot d-1.
+void drawCellContents(SDL_Renderer* renderer, const Board& board, const BoardState& state, int row, int col, int originY) {
+    int index = row * GRID_SIZE + col;
+    SDL_Rect cell = {col * CELL_SIZE, row * CELL_SIZE + originY, CELL_SIZE, CELL_SIZE};
+    int number = board.cells[index];
+    if (number != 0) {
+        SDL_Color textColor = board.isGiven(row, col) ? ORIGINAL_NUMBER_COLOR : NUMBER_COLOR;
+        if (cellConflicts(state, index)) textColor = CONFLICT_NUMBER_COLOR;
+        drawGlyph(renderer, ATLAS_LARGE, (char)('0' + number), cell, textColor);
+        return;
+    }
+
+    uint16_t marks = state.pencil[index];
+    int slot = CELL_SIZE / BOX_SIZE;
+    for (int digit = 1; digit <= GRID_SIZE; digit++) {
+        if (!(marks & (1 << (digit - 1)))) continue;
+        SDL_Rect mark = {cell.x + ((digit - 1) % BOX_SIZE) * slot, cell.y + ((digit - 1) / BOX_SIZE) * slot, slot, slot};
+        drawGlyph(renderer, ATLAS_SMALL, (char)('0' + digit), mark, PENCIL_COLOR);
+    }
+}
+
+void drawBackground(SDL_Renderer* renderer, int originY) {
+    if (gBackground) {
+        SDL_Rect destRect = {0, originY, GAME_AREA_SIZE, GAME_AREA_SIZE};
+        SDL_RenderCopy(renderer, gBackground, NULL, &destRect);
+    } else {
+        drawRectangle(renderer, 0, originY, GAME_AREA_SIZE, GAME_AREA_SIZE, WHITE);
+    }
+}
+
+void drawGridLines(SDL_Renderer* renderer, int originY) {
+    for (int i = 0; i <= GRID_SIZE; ++i) {
+        int lineY = i * CELL_SIZE + originY;
+        int lineWidth = (i % BOX_SIZE == 0) ? THICK_LINE_WIDTH : LINE_WIDTH;
+        drawLine(renderer, 0, lineY, GAME_AREA_SIZE, lineY, lineWidth);
+
+        int lineX = i * CELL_SIZE;
+        drawLine(renderer, lineX, originY, lineX, originY + GAME_AREA_SIZE, lineWidth);
+    }
+}
+
+void drawBoardDirect(SDL_Renderer* renderer, const Board& board, const BoardState& state, int selected) {
+    TRACE_SCOPE("drawBoardDirect");
+    drawBackground(renderer, GAME_AREA_Y_OFFSET);
+    if (selected != -1) {
+        drawRectangle(renderer, (selected % GRID_SIZE) * CELL_SIZE, (selected / GRID_SIZE) * CELL_SIZE + GAME_AREA_Y_OFFSET,
+                      CELL_SIZE, CELL_SIZE, HIGHLIGHTED);
+    }
+    drawGridLines(renderer, GAME_AREA_Y_OFFSET);
+    for (int row = 0; row < GRID_SIZE; ++row) {
+        for (int col = 0; col < GRID_SIZE; ++col) {
+            drawCellContents(renderer, board, state, row, col, GAME_AREA_Y_OFFSET);
+        }
+    }
+}
+
+static int gridLineWidth(int i) {
+    return (i % BOX_SIZE == 0) ? THICK_LINE_WIDTH : LINE_WIDTH;
+}
+
+// The part of a cell not covered by the grid lines around it, in layer coordinates.
+static SDL_Rect cellInterior(int row, int col) {
+    int left = col * CELL_SIZE + (gridLineWidth(col) + 1) / 2;
+    int right = (col + 1) * CELL_SIZE - gridLineWidth(col + 1) / 2;
+    int top = row * CELL_SIZE + (gridLineWidth(row) + 1) / 2;
+    int bottom = (row + 1) * CELL_SIZE - gridLineWidth(row + 1) / 2;
+    return {left, top, right - left, bottom - top};
+}
+
+static void drawLayerCell(SDL_Renderer* renderer, const Board& board, const BoardState& state,
+                          int row, int col, bool selected) {
+    SDL_Rect interior = cellInterior(row, col);
+    SDL_Color fill = selected ? HIGHLIGHTED : SDL_Color{0, 0, 0, 0};
+    drawRectangle(renderer, interior.x, interior.y, interior.w, interior.h, fill);
+    drawCellContents(renderer, board, state, row, col, 0);
+}
+
+static bool conflictBit(const uint64_t* bits, int cell) {
+    return (bits[cell >> 6] >> (cell & 63)) & 1;
+}
+
+static bool createBoardLayers(SDL_Renderer* renderer) {
+    if (!SDL_RenderTargetSupported(renderer)) {
+        gLayers.unsupported = true;
+        return false;
+    }
+
+    gLayers.grid = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                     GAME_AREA_SIZE, GAME_AREA_SIZE);
+    gLayers.cells = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                      GAME_AREA_SIZE, GAME_AREA_SIZE);
+    countTextureAllocation();
+    countTextureAllocation();
+    if (gLayers.grid == nullptr || gLayers.cells == nullptr) {
+        cerr << "Khong the tao texture cho cac lop ban co! SDL Error: " << SDL_GetError() << endl;
+        freeBoardLayers();
+        gLayers.unsupported = true;
+        return false;
+    }
+    SDL_SetTextureBlendMode(gLayers.cells, SDL_BLENDMODE_BLEND);
+    invalidateBoardLayers();
+    return true;
+}
+
+bool renderBoardLayers(SDL_Renderer* renderer, const Board& board, const BoardState& state, int selected) {
+    TRACE_SCOPE("renderBoardLayers");
+    if (gLayers.unsupported) return false;
+    if (gLayers.grid == nullptr && !createBoardLayers(renderer)) return false;
+
+    bool targetSet = false;
+    if (!gLayers.gridValid) {
+        SDL_SetRenderTarget(renderer, gLayers.grid);
+        targetSet = true;
+        drawBackground(renderer, 0);
+        drawGridLines(renderer, 0);
+        gLayers.gridValid = true;
+    }
+
+    bool unchanged = gLayers.cellsValid && state.version == gLayers.shownVersion && selected == gLayers.shownSelected;
+    bool cellsTargeted = false;
+    for (int cell = 0; cell < BOARD_CELLS && !unchanged; ++cell) {
+        int row = cell / GRID_SIZE;
+        int col = cell % GRID_SIZE;
+        bool dirty = !gLayers.cellsValid
+                  || board.cells[cell] != gLayers.shown.cells[cell]
+                  || board.isGiven(row, col) != gLayers.shown.isGiven(row, col)
+                  || state.pencil[cell] != gLayers.shownPencil[cell]
+                  || cellConflicts(state, cell) != conflictBit(gLayers.shownConflicts, cell)
+                  || (cell == selected) != (cell == gLayers.shownSelected);
+        if (!dirty) continue;
+
+        if (!cellsTargeted) {
+            SDL_SetRenderTarget(renderer, gLayers.cells);
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+            if (!gLayers.cellsValid) {
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+                SDL_RenderClear(renderer);
+            }
+            cellsTargeted = true;
+            targetSet = true;
+        }
+        drawLayerCell(renderer, board, state, row, col, cell == selected);
+    }
+
+    if (targetSet) {
+        SDL_SetRenderTarget(renderer, nullptr);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    }
+    if (!unchanged) {
+        gLayers.shown = board;
+        memcpy(gLayers.shownPencil, state.pencil, sizeof(gLayers.shownPencil));
+        memcpy(gLayers.shownConflicts, state.conflictBits, sizeof(gLayers.shownConflicts));
+        gLayers.shownVersion = state.version;
+        gLayers.shownSelected = selected;
+        gLayers.cellsValid = true;
+    }
+
+    SDL_Rect destRect = {0, GAME_AREA_Y_OFFSET, GAME_AREA_SIZE, GAME_AREA_SIZE};
+    SDL_RenderCopy(renderer, gLayers.grid, NULL, &destRect);
+    SDL_RenderCopy(renderer, gLayers.cells, NULL, &destRect);
+    return true;
+}
+
+void invalidateBoardLayers() {
+    gLayers.gridValid = false;
+    gLayers.cellsValid = false;
+}
+
+void setBoardBackground(SDL_Texture* texture) {
+    gBackground = texture;
+    invalidateBoardLayers();
+}
+
+void freeBoardLayers() {
+    SDL_DestroyTexture(gLayers.grid);
+    SDL_DestroyTexture(gLayers.cells);
+    gLayers.grid = nullptr;
+    gLayers.cells = nullptr;
+    invalidateBoardLayers();
+}
+
+void drawTimer(SDL_Renderer* renderer, int timeLeft) {
+    TRACE_SCOPE("drawTimer");
+    int minutes = timeLeft / 60;
+    int seconds = timeLeft % 60;
+
+    char timeString[32];
+    snprintf(timeString, sizeof(timeString), "Time: %02d:%02d", minutes, seconds);
+
+    int y = (UI_AREA_HEIGHT - glyphTextHeight(ATLAS_SMALL)) / 2;
+    drawGlyphText(renderer, ATLAS_SMALL, timeString, 15, y, TIMER_COLOR);
+}
+
+void drawTries(SDL_Renderer* renderer, int triesLeft) {
+    TRACE_SCOPE("drawTries");
+    char triesString[32];
+    snprintf(triesString, sizeof(triesString), "Loi sai con lai: %d", triesLeft);
+
+    int x = SCREEN_WIDTH - glyphTextWidth(ATLAS_SMALL, triesString) - 15;
+    int y = (UI_AREA_HEIGHT - glyphTextHeight(ATLAS_SMALL)) / 2;
+    drawGlyphText(renderer, ATLAS_SMALL, triesString, x, y, TRIES_COLOR);
+}
+
+void drawHint(SDL_Renderer* renderer, Technique technique) {
+    TRACE_SCOPE("drawHint");
+    char hintString[64];
+    snprintf(hintString, sizeof(hintString), "Goi y: %s", techniqueName(technique));
+
+    int x = (SCREEN_WIDTH - glyphTextWidth(ATLAS_SMALL, hintString)) / 2;
+    int y = (UI_AREA_HEIGHT - glyphTextHeight(ATLAS_SMALL)) / 2;
+    drawGlyphText(renderer, ATLAS_SMALL, hintString, x, y, HINT_COLOR);
+}
+
+void drawPerfOverlay(SDL_Renderer* renderer, const FrameSummary& summary) {
+    TRACE_SCOPE("drawPerfOverlay");
+    drawRectangle(renderer, 0, 0, SCREEN_WIDTH, UI_AREA_HEIGHT, OVERLAY_BACKGROUND);
+
+    char overlayString[128];
+    snprintf(overlayString, sizeof(overlayString),
+             "p50 %.1f p95 %.1f p99 %.1f max %.1f ms | present %.1f | tex %d",
+             summary.cpuP50, summary.cpuP95, summary.cpuP99, summary.cpuMax, summary.presentP99, summary.textures);
+    int y = (UI_AREA_HEIGHT - glyphTextHeight(ATLAS_SMALL)) / 2;
+    drawGlyphText(renderer, ATLAS_SMALL, overlayString, 6, y, WHITE);
+}
@@ -0,0 +1,49 @@
+#ifndef BOARD_RENDER_H
+#define BOARD_RENDER_H
+
+#include <SDL.h>
+#include "board_layout.h"
+#include "board_state.h"
+#include "frame_scheduler.h"
+#include "grader.h"
+
+const int LINE_WIDTH = 2;
+const int THICK_LINE_WIDTH = 4;
+
+
+const SDL_Color WHITE = {255, 255, 255, 255};
+const SDL_Color BLACK = {0, 0, 0, 255};
+const SDL_Color GRAY = {220, 220, 220, 255};
+const SDL_Color HIGHLIGHTED = {180, 210, 255, 180};
+const SDL_Color NUMBER_COLOR = {0, 0, 150, 255};
+const SDL_Color ORIGINAL_NUMBER_COLOR = {0, 0, 0, 255};
+const SDL_Color CONFLICT_NUMBER_COLOR = {200, 0, 0, 255};
+const SDL_Color PENCIL_COLOR = {90, 90, 90, 255};
+const SDL_Color TIMER_COLOR = {255, 0, 0, 255};
+const SDL_Color TRIES_COLOR = {0, 100, 0, 255};
+const SDL_Color HINT_COLOR = {0, 0, 150, 255};
+const SDL_Color OVERLAY_BACKGROUND = {0, 0, 0, 200};
+
+// Board and HUD drawing, shared by the game and the benchmarks. Text goes
+// through the glyph atlas in text_cache. `selected` is the highlighted cell
+// index, or -1 for none.
+void drawLine(SDL_Renderer* renderer, int x1, int y1, int x2, int y2, int width);
+void drawRectangle(SDL_Renderer* renderer, int x, int y, int w, int h, SDL_Color color);
+void drawCellContents(SDL_Renderer* renderer, const Board& board, const BoardState& state, int row, int col, int originY);
+void drawBackground(SDL_Renderer* renderer, int originY);
+void drawGridLines(SDL_Renderer* renderer, int originY);
+void drawBoardDirect(SDL_Renderer* renderer, const Board& board, const BoardState& state, int selected);
+// Draws through two cached target textures; false when the renderer cannot
+// render to textures, and drawBoardDirect has to be used instead.
+bool renderBoardLayers(SDL_Renderer* renderer, const Board& board, const BoardState& state, int selected);
+void invalidateBoardLayers();
+// The texture is not owned; it stays in use until replaced.
+void setBoardBackground(SDL_Texture* texture);
+void freeBoardLayers();
+void drawTimer(SDL_Renderer* renderer, int timeLeft);
+void drawTries(SDL_Renderer* renderer, int triesLeft);
+void drawHint(SDL_Renderer* renderer, Technique technique);
+// Replaces the HUD line with the frame statistics.
+void drawPerfOverlay(SDL_Renderer* renderer, const FrameSummary& summary);
+
+#endif
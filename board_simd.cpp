@@ -0,0 +1,229 @@
+#include "board_simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BOARD_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+
+const uint16_t ALL_DIGIT_BITS = 0x1FF;
+
+static inline int boxOf(int row, int col) {
+    return (row / 3) * 3 + col / 3;
+}
+
+static void masksScalar(const Board& board, BoardMasks& masks) {
+    uint16_t rowSum[GRID_SIZE] = {0};
+    uint16_t colSum[GRID_SIZE] = {0};
+    uint16_t boxSum[GRID_SIZE] = {0};
+    for (int i = 0; i < GRID_SIZE; i++) {
+        masks.rows[i] = 0;
+        masks.cols[i] = 0;
+        masks.boxes[i] = 0;
+    }
+
+    for (int i = 0; i < BOARD_CELLS; i++) {
+        int value = board.cells[i];
+        if (value == 0) continue;
+        uint16_t bit = 1 << (value - 1);
+        int row = i / GRID_SIZE, col = i % GRID_SIZE, box = boxOf(row, col);
+        masks.rows[row] |= bit;
+        masks.cols[col] |= bit;
+        masks.boxes[box] |= bit;
+        rowSum[row] += bit;
+        colSum[col] += bit;
+        boxSum[box] += bit;
+    }
+
+    masks.consistent = true;
+    for (int i = 0; i < GRID_SIZE; i++) {
+        if (rowSum[i] != masks.rows[i] || colSum[i] != masks.cols[i] || boxSum[i] != masks.boxes[i]) {
+            masks.consistent = false;
+        }
+    }
+}
+
+static void candidatesScalar(const Board& board, uint16_t* candidates) {
+    BoardMasks masks;
+    masksScalar(board, masks);
+    for (int i = 0; i < BOARD_CELLS; i++) {
+        int row = i / GRID_SIZE, col = i % GRID_SIZE;
+        candidates[i] = board.cells[i] ? 0
+            : ALL_DIGIT_BITS & ~(masks.rows[row] | masks.cols[col] | masks.boxes[boxOf(row, col)]);
+    }
+}
+
+#ifdef BOARD_SIMD_X86
+
+// One 16-bit lane per cell holding 1 << (value - 1), padded so that a
+// 16-lane load starting at any row stays inside the buffer.
+struct ExpandedBoard {
+    alignas(32) uint16_t bits[96];
+};
+
+__attribute__((target("avx2")))
+static void expandAvx2(const Board& board, ExpandedBoard& out) {
+    alignas(16) uint8_t cells[96] = {0};
+    memcpy(cells, board.cells, BOARD_CELLS);
+
+    const __m128i lowLut = _mm_setr_epi8(0, 1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i highLut = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0);
+    for (int chunk = 0; chunk < 6; chunk++) {
+        __m128i values = _mm_load_si128((const __m128i*)(cells + chunk * 16));
+        __m128i low = _mm_shuffle_epi8(lowLut, values);
+        __m128i high = _mm_shuffle_epi8(highLut, values);
+        _mm_store_si128((__m128i*)(out.bits + chunk * 16), _mm_unpacklo_epi8(low, high));
+        _mm_store_si128((__m128i*)(out.bits + chunk * 16 + 8), _mm_unpackhi_epi8(low, high));
+    }
+}
+
+__attribute__((target("avx2")))
+static inline uint16_t reduceOr(__m256i v) {
+    __m128i x = _mm_or_si128(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    x = _mm_or_si128(x, _mm_srli_si128(x, 8));
+    x = _mm_or_si128(x, _mm_srli_si128(x, 4));
+    x = _mm_or_si128(x, _mm_srli_si128(x, 2));
+    return (uint16_t)_mm_extract_epi16(x, 0);
+}
+
+__attribute__((target("avx2")))
+static inline uint16_t reduceAdd(__m256i v) {
+    __m128i x = _mm_add_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    x = _mm_add_epi16(x, _mm_srli_si128(x, 8));
+    x = _mm_add_epi16(x, _mm_srli_si128(x, 4));
+    x = _mm_add_epi16(x, _mm_srli_si128(x, 2));
+    return (uint16_t)_mm_extract_epi16(x, 0);
+}
+
+// Each row is loaded as one 16-lane vector (lanes 9..15 masked off). Columns
+// are the OR of the row vectors, bands of three rows give the boxes. Sums run
+// alongside the ORs: a unit repeats a digit exactly when its sum differs.
+__attribute__((target("avx2")))
+static void masksAvx2(const ExpandedBoard& expanded, BoardMasks& masks, __m256i& colsOut) {
+    const __m256i keepNine = _mm256_setr_epi16(-1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0);
+    __m256i colOr = _mm256_setzero_si256();
+    __m256i colAdd = _mm256_setzero_si256();
+    __m256i bandOr[3] = {colOr, colOr, colOr};
+    __m256i bandAdd[3] = {colOr, colOr, colOr};
+    bool consistent = true;
+
+    for (int row = 0; row < GRID_SIZE; row++) {
+        __m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(expanded.bits + row * GRID_SIZE)), keepNine);
+        colOr = _mm256_or_si256(colOr, v);
+        colAdd = _mm256_add_epi16(colAdd, v);
+        bandOr[row / 3] = _mm256_or_si256(bandOr[row / 3], v);
+        bandAdd[row / 3] = _mm256_add_epi16(bandAdd[row / 3], v);
+
+        masks.rows[row] = reduceOr(v);
+        if (reduceAdd(v) != masks.rows[row]) consistent = false;
+    }
+
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(colOr, colAdd)) != -1) consistent = false;
+
+    alignas(32) uint16_t lanes[16];
+    _mm256_store_si256((__m256i*)lanes, colOr);
+    for (int col = 0; col < GRID_SIZE; col++) masks.cols[col] = lanes[col];
+
+    for (int band = 0; band < 3; band++) {
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(bandOr[band], bandAdd[band])) != -1) consistent = false;
+
+        alignas(32) uint16_t sums[16];
+        _mm256_store_si256((__m256i*)lanes, bandOr[band]);
+        _mm256_store_si256((__m256i*)sums, bandAdd[band]);
+        for (int stack = 0; stack < 3; stack++) {
+            int first = stack * 3;
+            uint16_t boxOr = lanes[first] | lanes[first + 1] | lanes[first + 2];
+            uint16_t boxAdd = sums[first] + sums[first + 1] + sums[first + 2];
+            masks.boxes[band * 3 + stack] = boxOr;
+            if (boxOr != boxAdd) consistent = false;
+        }
+    }
+    masks.consistent = consistent;
+    colsOut = colOr;
+}
+
+__attribute__((target("avx2")))
+static void boardMasksAvx2(const Board& board, BoardMasks& masks) {
+    ExpandedBoard expanded;
+    __m256i cols;
+    expandAvx2(board, expanded);
+    masksAvx2(expanded, masks, cols);
+}
+
+__attribute__((target("avx2")))
+static void candidatesAvx2(const Board& board, uint16_t* candidates) {
+    ExpandedBoard expanded;
+    BoardMasks masks;
+    __m256i cols;
+    expandAvx2(board, expanded);
+    masksAvx2(expanded, masks, cols);
+
+    const __m256i allDigits = _mm256_set1_epi16(ALL_DIGIT_BITS);
+    for (int band = 0; band < 3; band++) {
+        const uint16_t* b = masks.boxes + band * 3;
+        __m256i boxes = _mm256_setr_epi16(b[0], b[0], b[0], b[1], b[1], b[1], b[2], b[2], b[2], 0, 0, 0, 0, 0, 0, 0);
+        __m256i colsAndBoxes = _mm256_or_si256(cols, boxes);
+
+        for (int row = band * 3; row < band * 3 + 3; row++) {
+            __m256i cells = _mm256_loadu_si256((const __m256i*)(expanded.bits + row * GRID_SIZE));
+            __m256i empty = _mm256_cmpeq_epi16(cells, _mm256_setzero_si256());
+            __m256i used = _mm256_or_si256(colsAndBoxes, _mm256_set1_epi16(masks.rows[row]));
+            __m256i open = _mm256_and_si256(_mm256_andnot_si256(used, allDigits), empty);
+
+            alignas(32) uint16_t lanes[16];
+            _mm256_store_si256((__m256i*)lanes, open);
+            memcpy(candidates + row * GRID_SIZE, lanes, GRID_SIZE * sizeof(uint16_t));
+        }
+    }
+}
+
+#endif
+
+struct BoardKernels {
+    void (*masks)(const Board&, BoardMasks&);
+    void (*candidates)(const Board&, uint16_t*);
+    const char* name;
+};
+
+static BoardKernels selectKernels() {
+#ifdef BOARD_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {boardMasksAvx2, candidatesAvx2, "avx2"};
+#endif
+    return {masksScalar, candidatesScalar, "scalar"};
+}
+
+static const BoardKernels& kernels() {
+    static const BoardKernels selected = selectKernels();
+    return selected;
+}
+
+void computeBoardMasks(const Board& board, BoardMasks& masks) {
+    kernels().masks(board, masks);
+}
+
+void computeAllCandidates(const Board& board, uint16_t* candidates) {
+    kernels().candidates(board, candidates);
+}
+
+bool isBoardConsistent(const Board& board) {
+    BoardMasks masks;
+    kernels().masks(board, masks);
+    return masks.consistent;
+}
+
+bool isBoardSolved(const Board& board) {
+    BoardMasks masks;
+    kernels().masks(board, masks);
+    if (!masks.consistent) return false;
+    for (int i = 0; i < GRID_SIZE; i++) {
+        if (masks.rows[i] != ALL_DIGIT_BITS) return false;
+    }
+    return true;
+}
+
+const char* boardKernelName() {
+    return kernels().name;
+}
@@ -0,0 +1,24 @@
+#ifndef BOARD_SIMD_H
+#define BOARD_SIMD_H
+
+#include <cstdint>
+#include "board.h"
+
+// Occupancy of every row, column and box (bit d-1 = digit d present).
+// consistent is false when any unit repeats a digit.
+struct BoardMasks {
+    uint16_t rows[GRID_SIZE];
+    uint16_t cols[GRID_SIZE];
+    uint16_t boxes[GRID_SIZE];
+    bool consistent;
+};
+
+// The AVX2 kernels are picked at runtime when the CPU supports them,
+// otherwise the scalar ones are used.
+void computeBoardMasks(const Board& board, BoardMasks& masks);
+void computeAllCandidates(const Board& board, uint16_t* candidates);
+bool isBoardConsistent(const Board& board);
+bool isBoardSolved(const Board& board);
+const char* boardKernelName();
+
+#endif
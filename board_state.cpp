@@ -0,0 +1,156 @@
+#include "board_state.h"
+
+using namespace std;
+
+
+static int rowUnit(int cell) {
+    return cell / GRID_SIZE;
+}
+
+static int colUnit(int cell) {
+    return GRID_SIZE + cell % GRID_SIZE;
+}
+
+static int boxUnit(int cell) {
+    int row = cell / GRID_SIZE;
+    int col = cell % GRID_SIZE;
+    return 2 * GRID_SIZE + (row / 3) * 3 + col / 3;
+}
+
+static int unitCell(int unit, int k) {
+    int index = unit % GRID_SIZE;
+    if (unit < GRID_SIZE) return index * GRID_SIZE + k;
+    if (unit < 2 * GRID_SIZE) return k * GRID_SIZE + index;
+    return ((index / 3) * 3 + k / 3) * GRID_SIZE + (index % 3) * 3 + k % 3;
+}
+
+static void setConflict(BoardState& state, int cell, bool conflict) {
+    uint64_t bit = (uint64_t)1 << (cell & 63);
+    if (conflict) state.conflictBits[cell >> 6] |= bit;
+    else state.conflictBits[cell >> 6] &= ~bit;
+}
+
+static bool digitRepeats(const BoardState& state, int cell, int digit) {
+    return state.digitCount[rowUnit(cell)][digit] > 1
+        || state.digitCount[colUnit(cell)][digit] > 1
+        || state.digitCount[boxUnit(cell)][digit] > 1;
+}
+
+static uint16_t cellCandidates(const BoardState& state, int cell) {
+    return 0x1FF & ~(state.unitUsed[rowUnit(cell)] | state.unitUsed[colUnit(cell)] | state.unitUsed[boxUnit(cell)]);
+}
+
+// Only a count crossing between 1 and 2 changes which cells of the unit conflict.
+static void refreshUnitConflicts(BoardState& state, const Board& board, int unit, int digit) {
+    for (int k = 0; k < GRID_SIZE; k++) {
+        int cell = unitCell(unit, k);
+        if (board.cells[cell] == digit) setConflict(state, cell, digitRepeats(state, cell, digit));
+    }
+}
+
+static void addToUnit(BoardState& state, const Board& board, int unit, int digit) {
+    uint8_t count = ++state.digitCount[unit][digit];
+    state.unitUsed[unit] |= (uint16_t)(1 << (digit - 1));
+    if (count == 2) {
+        state.duplicates++;
+        refreshUnitConflicts(state, board, unit, digit);
+    } else if (count > 2) {
+        state.duplicates++;
+    }
+}
+
+static void removeFromUnit(BoardState& state, const Board& board, int unit, int digit) {
+    uint8_t count = --state.digitCount[unit][digit];
+    if (count == 0) state.unitUsed[unit] &= (uint16_t)~(1 << (digit - 1));
+    if (count >= 1) state.duplicates--;
+    if (count == 1) refreshUnitConflicts(state, board, unit, digit);
+}
+
+void initBoardState(BoardState& state, Board& board) {
+    unsigned version = state.version;
+    memset(&state, 0, sizeof(BoardState));
+    state.version = version + 1;
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        int digit = board.cells[cell];
+        if (digit == 0) continue;
+        state.filled++;
+        addToUnit(state, board, rowUnit(cell), digit);
+        addToUnit(state, board, colUnit(cell), digit);
+        addToUnit(state, board, boxUnit(cell), digit);
+    }
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        board.candidates[cell] = board.cells[cell] == 0 ? cellCandidates(state, cell) : 0;
+    }
+}
+
+void placeDigit(BoardState& state, Board& board, int cell, int digit) {
+    int old = board.cells[cell];
+    if (old == digit) return;
+
+    int units[3] = {rowUnit(cell), colUnit(cell), boxUnit(cell)};
+    if (old != 0) {
+        board.cells[cell] = 0;
+        setConflict(state, cell, false);
+        state.filled--;
+        for (int unit : units) removeFromUnit(state, board, unit, old);
+    }
+    if (digit != 0) {
+        board.cells[cell] = (uint8_t)digit;
+        state.filled++;
+        for (int unit : units) addToUnit(state, board, unit, digit);
+        setConflict(state, cell, digitRepeats(state, cell, digit));
+        state.pencil[cell] = 0;
+    }
+
+    // Peers are the cells of the three units; the cell itself is visited too.
+    uint16_t bit = digit != 0 ? (uint16_t)(1 << (digit - 1)) : 0;
+    for (int unit : units) {
+        for (int k = 0; k < GRID_SIZE; k++) {
+            int peer = unitCell(unit, k);
+            board.candidates[peer] = board.cells[peer] == 0 ? cellCandidates(state, peer) : 0;
+            state.pencil[peer] &= (uint16_t)~bit;
+        }
+    }
+    state.version++;
+}
+
+void togglePencilMark(BoardState& state, int cell, int digit) {
+    state.pencil[cell] ^= (uint16_t)(1 << (digit - 1));
+    state.version++;
+}
+
+void clearPencilMarks(BoardState& state, int cell) {
+    if (state.pencil[cell] == 0) return;
+    state.pencil[cell] = 0;
+    state.version++;
+}
+
+void setPencilMarks(BoardState& state, int cell, uint16_t marks) {
+    if (state.pencil[cell] == marks) return;
+    state.pencil[cell] = marks;
+    state.version++;
+}
+
+uint32_t peerPencilMarks(const BoardState& state, int cell, int digit) {
+    int units[3] = {rowUnit(cell), colUnit(cell), boxUnit(cell)};
+    uint16_t bit = (uint16_t)(1 << (digit - 1));
+    uint32_t peers = 0;
+    for (int u = 0; u < 3; u++) {
+        for (int k = 0; k < GRID_SIZE; k++) {
+            if (state.pencil[unitCell(units[u], k)] & bit) peers |= (uint32_t)1 << (u * GRID_SIZE + k);
+        }
+    }
+    return peers;
+}
+
+void restorePeerPencilMarks(BoardState& state, int cell, int digit, uint32_t peers) {
+    if (peers == 0) return;
+    int units[3] = {rowUnit(cell), colUnit(cell), boxUnit(cell)};
+    uint16_t bit = (uint16_t)(1 << (digit - 1));
+    for (int u = 0; u < 3; u++) {
+        for (int k = 0; k < GRID_SIZE; k++) {
+            if ((peers >> (u * GRID_SIZE + k)) & 1) state.pencil[unitCell(units[u], k)] |= bit;
+        }
+    }
+    state.version++;
+}
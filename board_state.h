@@ -0,0 +1,47 @@
+#ifndef BOARD_STATE_H
+#define BOARD_STATE_H
+
+#include <cstdint>
+#include "board.h"
+
+const int UNIT_COUNT = 3 * GRID_SIZE;
+
+// Live bookkeeping for the board being played. Every edit goes through
+// placeDigit/togglePencilMark, which update only the units and peers of the
+// changed cell, so the win check and conflict lookups are O(1) and nothing
+// is rescanned per frame. `version` changes on every edit.
+struct BoardState {
+    uint8_t digitCount[UNIT_COUNT][GRID_SIZE + 1];
+    uint16_t unitUsed[UNIT_COUNT];
+    uint16_t pencil[BOARD_CELLS];
+    uint64_t conflictBits[2];
+    int filled;
+    int duplicates;
+    unsigned version;
+};
+
+// Also fills board.candidates. The version keeps counting across boards, so
+// a caller comparing versions sees a new puzzle as a change.
+void initBoardState(BoardState& state, Board& board);
+// digit 0 clears the cell. Placing a digit removes it from the pencil marks
+// of every peer and clears the cell's own marks.
+void placeDigit(BoardState& state, Board& board, int cell, int digit);
+void togglePencilMark(BoardState& state, int cell, int digit);
+void clearPencilMarks(BoardState& state, int cell);
+void setPencilMarks(BoardState& state, int cell, uint16_t marks);
+// Bit u*9+k is set when cell k of the cell's u-th unit (row, column, box)
+// has `digit` pencilled in, which is what placeDigit erases; restoring puts
+// those marks back when the placement is undone.
+uint32_t peerPencilMarks(const BoardState& state, int cell, int digit);
+void restorePeerPencilMarks(BoardState& state, int cell, int digit, uint32_t peers);
+
+inline bool boardComplete(const BoardState& state) {
+    return state.filled == BOARD_CELLS && state.duplicates == 0;
+}
+
+// True if the cell's digit appears again in its row, column or box.
+inline bool cellConflicts(const BoardState& state, int cell) {
+    return (state.conflictBits[cell >> 6] >> (cell & 63)) & 1;
+}
+
+#endif
@@ -0,0 +1,174 @@
+#include "canonical.h"
+#include <cstring>
+#include <vector>
+#include "rng.h"
+
+using namespace std;
+
+
+static_assert(BOX_SIZE == 3, "canonical forms are for 9x9 boards");
+
+const int ORDERS_PER_LINE = 1296;  // 3! stack orders times 3!^3 orders inside the stacks
+
+struct LineOrders {
+    uint8_t order[ORDERS_PER_LINE][GRID_SIZE];
+
+    LineOrders() {
+        static const uint8_t perms[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+        int n = 0;
+        for (int stacks = 0; stacks < 6; stacks++)
+            for (int a = 0; a < 6; a++)
+                for (int b = 0; b < 6; b++)
+                    for (int c = 0; c < 6; c++) {
+                        const int inner[3] = {a, b, c};
+                        for (int s = 0; s < 3; s++) {
+                            for (int i = 0; i < 3; i++) {
+                                order[n][s * 3 + i] = perms[stacks][s] * 3 + perms[inner[s]][i];
+                            }
+                        }
+                        n++;
+                    }
+    }
+};
+
+// A partial transformation: the grid orientation and column order are fixed,
+// the rows are chosen one at a time, and digits are labelled in order of
+// first appearance.
+struct CanonState {
+    uint8_t columns[GRID_SIZE];
+    uint8_t labels[GRID_SIZE + 1];
+    uint8_t nextLabel;
+    uint8_t transposed;
+    uint16_t rowsUsed;
+};
+
+// Labels row `row` under `state` into `out` while comparing with `best`.
+// Returns -1 if smaller, 0 if equal, 1 if larger (then `out` is incomplete).
+static int labelRow(const uint8_t* grid, CanonState& state, int row, const uint8_t* best, uint8_t* out) {
+    int order = 0;
+    const uint8_t* line = grid + row * GRID_SIZE;
+    for (int i = 0; i < GRID_SIZE; i++) {
+        int digit = line[state.columns[i]];
+        if (digit != 0 && state.labels[digit] == 0) state.labels[digit] = state.nextLabel++;
+        out[i] = state.labels[digit];
+        if (order == 0) {
+            if (out[i] > best[i]) return 1;
+            if (out[i] < best[i]) order = -1;
+        }
+    }
+    return order;
+}
+
+// Keeps the candidates whose next row is smallest. Lexicographic order is
+// row by row, so every optimal transformation survives each round and the
+// search is exact; in practice the list collapses after a few rows.
+static void offerRow(const uint8_t* grid, const CanonState& from, int row, uint8_t* best,
+                     vector<CanonState>& next) {
+    CanonState state = from;
+    uint8_t labelled[GRID_SIZE];
+    int order = labelRow(grid, state, row, best, labelled);
+    if (order > 0) return;
+    if (order < 0) {
+        memcpy(best, labelled, GRID_SIZE);
+        next.clear();
+    }
+    state.rowsUsed |= 1 << row;
+    next.push_back(state);
+}
+
+void canonicalizePuzzle(const uint8_t* cells, uint8_t* canonical) {
+    static const LineOrders orders;
+    thread_local vector<CanonState> states;
+    thread_local vector<CanonState> next;
+
+    uint8_t grids[2][BOARD_CELLS];
+    memcpy(grids[0], cells, BOARD_CELLS);
+    for (int r = 0; r < GRID_SIZE; r++) {
+        for (int c = 0; c < GRID_SIZE; c++) grids[1][c * GRID_SIZE + r] = cells[r * GRID_SIZE + c];
+    }
+
+    uint8_t* best = canonical;
+    memset(best, GRID_SIZE + 1, GRID_SIZE);
+    next.clear();
+    CanonState start = {};
+    start.nextLabel = 1;
+    for (int transposed = 0; transposed < 2; transposed++) {
+        start.transposed = transposed;
+        for (int o = 0; o < ORDERS_PER_LINE; o++) {
+            memcpy(start.columns, orders.order[o], GRID_SIZE);
+            for (int row = 0; row < GRID_SIZE; row++) offerRow(grids[transposed], start, row, best, next);
+        }
+    }
+
+    for (int position = 1; position < GRID_SIZE; position++) {
+        states.swap(next);
+        next.clear();
+        best += GRID_SIZE;
+        memset(best, GRID_SIZE + 1, GRID_SIZE);
+        for (const CanonState& state : states) {
+            // Inside a band the rows left in that band; at a band boundary
+            // any row of a band not used yet.
+            int band = -1;
+            for (int b = 0; b < BOX_SIZE; b++) {
+                int used = (state.rowsUsed >> (b * BOX_SIZE)) & 7;
+                if (used != 0 && used != 7) band = b;
+            }
+            for (int row = 0; row < GRID_SIZE; row++) {
+                if (state.rowsUsed & (1 << row)) continue;
+                int rowBand = row / BOX_SIZE;
+                if (band >= 0 ? rowBand != band : (state.rowsUsed >> (rowBand * BOX_SIZE)) & 7) continue;
+                offerRow(grids[state.transposed], state, row, best, next);
+            }
+        }
+    }
+}
+
+uint64_t canonicalFingerprint(const uint8_t* cells) {
+    uint8_t canonical[BOARD_CELLS + 7] = {};
+    canonicalizePuzzle(cells, canonical);
+
+    uint64_t hash = 0;
+    for (int i = 0; i < BOARD_CELLS; i += 8) {
+        uint64_t word;
+        memcpy(&word, canonical + i, 8);
+        hash = splitMix64(hash ^ word);
+    }
+    // 0 marks an empty slot in DedupTable.
+    return hash != 0 ? hash : 1;
+}
+
+void initDedupTable(DedupTable& table, size_t expectedItems) {
+    size_t capacity = 1024;
+    while (capacity < expectedItems + expectedItems / 2) capacity *= 2;
+    table.slots.reset(new DedupSlot[capacity]);
+    table.mask = capacity - 1;
+}
+
+bool claimFingerprint(DedupTable& table, uint64_t fingerprint, uint64_t index) {
+    size_t slot = (size_t)fingerprint & table.mask;
+    for (size_t probe = 0; probe <= table.mask; probe++, slot = (slot + 1) & table.mask) {
+        DedupSlot& entry = table.slots[slot];
+        uint64_t found = entry.fingerprint.load(memory_order_relaxed);
+        if (found == 0 && entry.fingerprint.compare_exchange_strong(found, fingerprint, memory_order_relaxed)) {
+            found = fingerprint;
+        }
+        if (found != fingerprint) continue;
+
+        // firstIndex only ever goes down, so claims can land in any order.
+        uint64_t current = entry.firstIndex.load(memory_order_relaxed);
+        while (index < current && !entry.firstIndex.compare_exchange_weak(current, index, memory_order_relaxed)) {}
+        return true;
+    }
+    return false;
+}
+
+bool isFirstOccurrence(const DedupTable& table, uint64_t fingerprint, uint64_t index) {
+    size_t slot = (size_t)fingerprint & table.mask;
+    for (size_t probe = 0; probe <= table.mask; probe++, slot = (slot + 1) & table.mask) {
+        const DedupSlot& entry = table.slots[slot];
+        uint64_t found = entry.fingerprint.load(memory_order_relaxed);
+        if (found == 0) return false;
+        if (found == fingerprint) return entry.firstIndex.load(memory_order_relaxed) == index;
+    }
+    return false;
+}
@@ -0,0 +1,38 @@
+#ifndef CANONICAL_H
+#define CANONICAL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "board.h"
+
+// The lexicographically smallest grid reachable by transposing, permuting
+// bands and stacks, permuting rows and columns inside them and relabelling
+// digits. Empty cells stay 0, so two puzzles are isomorphic exactly when
+// their canonical forms are equal. 9x9 only.
+void canonicalizePuzzle(const uint8_t* cells, uint8_t* canonical);
+uint64_t canonicalFingerprint(const uint8_t* cells);
+
+// Lock-free open-addressed map from fingerprint to the smallest stream
+// index that produced it. Threads claim in any order, and afterwards an item
+// is kept iff it holds the first index of its fingerprint, so the result
+// does not depend on scheduling. Capacity is fixed at 1.5x the expected
+// number of distinct fingerprints or more. Checks must wait until every
+// claim has finished (the thread pool's wait gives that ordering).
+struct DedupSlot {
+    std::atomic<uint64_t> fingerprint{0};
+    std::atomic<uint64_t> firstIndex{UINT64_MAX};
+};
+
+struct DedupTable {
+    std::unique_ptr<DedupSlot[]> slots;
+    size_t mask = 0;
+};
+
+void initDedupTable(DedupTable& table, size_t expectedItems);
+// False only when the table is full.
+bool claimFingerprint(DedupTable& table, uint64_t fingerprint, uint64_t index);
+bool isFirstOccurrence(const DedupTable& table, uint64_t fingerprint, uint64_t index);
+
+#endif
@@ -0,0 +1,193 @@
+#include "dlx.h"
+
+using namespace std;
+
+
+static void coverColumn(DlxSolver& dlx, int c) {
+    dlx.right[dlx.left[c]] = dlx.right[c];
+    dlx.left[dlx.right[c]] = dlx.left[c];
+    for (int i = dlx.down[c]; i != c; i = dlx.down[i]) {
+        for (int j = dlx.right[i]; j != i; j = dlx.right[j]) {
+            dlx.down[dlx.up[j]] = dlx.down[j];
+            dlx.up[dlx.down[j]] = dlx.up[j];
+            dlx.size[dlx.column[j]]--;
+        }
+    }
+}
+
+static void uncoverColumn(DlxSolver& dlx, int c) {
+    for (int i = dlx.up[c]; i != c; i = dlx.up[i]) {
+        for (int j = dlx.left[i]; j != i; j = dlx.left[j]) {
+            dlx.size[dlx.column[j]]++;
+            dlx.down[dlx.up[j]] = j;
+            dlx.up[dlx.down[j]] = j;
+        }
+    }
+    dlx.right[dlx.left[c]] = c;
+    dlx.left[dlx.right[c]] = c;
+}
+
+void initDlx(DlxSolver& dlx) {
+    for (int c = 0; c <= DLX_COLUMNS; c++) {
+        dlx.left[c] = (c == 0) ? DLX_COLUMNS : c - 1;
+        dlx.right[c] = (c == DLX_COLUMNS) ? 0 : c + 1;
+        dlx.up[c] = c;
+        dlx.down[c] = c;
+        dlx.column[c] = c;
+        dlx.rowOf[c] = -1;
+        dlx.size[c] = 0;
+        dlx.covered[c] = false;
+    }
+
+    int node = DLX_COLUMNS + 1;
+    for (int row = 0; row < DLX_ROWS; row++) {
+        int cell = row / 9;
+        int digit = row % 9;
+        int r = cell / 9;
+        int c = cell % 9;
+        int b = (r / 3) * 3 + c / 3;
+        int cols[4] = {1 + cell, 1 + 81 + r * 9 + digit, 1 + 162 + c * 9 + digit, 1 + 243 + b * 9 + digit};
+
+        dlx.rowStart[row] = node;
+        for (int k = 0; k < 4; k++) {
+            int col = cols[k];
+            dlx.column[node] = col;
+            dlx.rowOf[node] = row;
+            dlx.up[node] = dlx.up[col];
+            dlx.down[node] = col;
+            dlx.down[dlx.up[col]] = node;
+            dlx.up[col] = node;
+            dlx.size[col]++;
+            dlx.left[node] = (k == 0) ? node + 3 : node - 1;
+            dlx.right[node] = (k == 3) ? node - 3 : node + 1;
+            node++;
+        }
+    }
+    dlx.givenCount = 0;
+    dlx.depth = 0;
+}
+
+static void unloadBoard(DlxSolver& dlx) {
+    while (dlx.givenCount > 0) {
+        int start = dlx.rowStart[dlx.givens[--dlx.givenCount]];
+        int j = start;
+        do {
+            j = dlx.left[j];
+            uncoverColumn(dlx, dlx.column[j]);
+            dlx.covered[dlx.column[j]] = false;
+        } while (j != start);
+    }
+}
+
+static bool loadBoard(DlxSolver& dlx, const Board& board) {
+    dlx.depth = 0;
+    for (int cell = 0; cell < 81; cell++) {
+        int value = board.cells[cell];
+        if (value == 0) continue;
+        if (value < 1 || value > 9) {
+            unloadBoard(dlx);
+            return false;
+        }
+
+        int row = cell * 9 + value - 1;
+        int start = dlx.rowStart[row];
+        int j = start;
+        do {
+            if (dlx.covered[dlx.column[j]]) {
+                unloadBoard(dlx);
+                return false;
+            }
+            j = dlx.right[j];
+        } while (j != start);
+
+        do {
+            coverColumn(dlx, dlx.column[j]);
+            dlx.covered[dlx.column[j]] = true;
+            j = dlx.right[j];
+        } while (j != start);
+        dlx.givens[dlx.givenCount++] = row;
+    }
+    return true;
+}
+
+static void writeSolution(const DlxSolver& dlx, Board& out) {
+    for (int i = 0; i < dlx.givenCount; i++) {
+        int row = dlx.givens[i];
+        out.cells[row / 9] = row % 9 + 1;
+    }
+    for (int i = 0; i < dlx.depth; i++) {
+        int row = dlx.partial[i];
+        out.cells[row / 9] = row % 9 + 1;
+    }
+}
+
+// Returns false once the callback asks to stop.
+template <typename OnSolution>
+static bool search(DlxSolver& dlx, OnSolution& onSolution) {
+    if (dlx.right[0] == 0) return onSolution();
+
+    int best = dlx.right[0];
+    for (int c = dlx.right[best]; c != 0; c = dlx.right[c]) {
+        if (dlx.size[c] < dlx.size[best]) {
+            best = c;
+            if (dlx.size[c] <= 1) break;
+        }
+    }
+    if (dlx.size[best] == 0) return true;
+
+    coverColumn(dlx, best);
+    bool keepGoing = true;
+    for (int r = dlx.down[best]; r != best && keepGoing; r = dlx.down[r]) {
+        dlx.partial[dlx.depth++] = dlx.rowOf[r];
+        for (int j = dlx.right[r]; j != r; j = dlx.right[j]) coverColumn(dlx, dlx.column[j]);
+
+        keepGoing = search(dlx, onSolution);
+
+        for (int j = dlx.left[r]; j != r; j = dlx.left[j]) uncoverColumn(dlx, dlx.column[j]);
+        dlx.depth--;
+    }
+    uncoverColumn(dlx, best);
+    return keepGoing;
+}
+
+bool dlxSolve(DlxSolver& dlx, Board& board) {
+    if (!loadBoard(dlx, board)) return false;
+
+    bool found = false;
+    auto onSolution = [&]() {
+        writeSolution(dlx, board);
+        found = true;
+        return false;
+    };
+    search(dlx, onSolution);
+    unloadBoard(dlx);
+    return found;
+}
+
+int dlxCountSolutions(DlxSolver& dlx, const Board& board, int limit) {
+    if (limit <= 0 || !loadBoard(dlx, board)) return 0;
+
+    int count = 0;
+    auto onSolution = [&]() {
+        return ++count < limit;
+    };
+    search(dlx, onSolution);
+    unloadBoard(dlx);
+    return count;
+}
+
+long long dlxEnumerate(DlxSolver& dlx, const Board& board,
+                       const function<bool(const Board&)>& visit) {
+    if (!loadBoard(dlx, board)) return 0;
+
+    long long count = 0;
+    Board solution = board;
+    auto onSolution = [&]() {
+        count++;
+        writeSolution(dlx, solution);
+        return visit(solution);
+    };
+    search(dlx, onSolution);
+    unloadBoard(dlx);
+    return count;
+}
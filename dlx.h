@@ -0,0 +1,35 @@
+#ifndef DLX_H
+#define DLX_H
+
+#include <functional>
+#include "board.h"
+
+const int DLX_COLUMNS = 324;
+const int DLX_ROWS = 729;
+const int DLX_NODES = 1 + DLX_COLUMNS + DLX_ROWS * 4;
+
+// 324-column exact-cover matrix in a fixed node arena.
+// Node 0 is the root, 1..324 are column headers, then 4 nodes per (cell, digit) row.
+struct DlxSolver {
+    int left[DLX_NODES];
+    int right[DLX_NODES];
+    int up[DLX_NODES];
+    int down[DLX_NODES];
+    int column[DLX_NODES];
+    int rowOf[DLX_NODES];
+    int size[DLX_COLUMNS + 1];
+    int rowStart[DLX_ROWS];
+    bool covered[DLX_COLUMNS + 1];
+    int givens[81];
+    int givenCount;
+    int partial[81];
+    int depth;
+};
+
+void initDlx(DlxSolver& dlx);
+bool dlxSolve(DlxSolver& dlx, Board& board);
+int dlxCountSolutions(DlxSolver& dlx, const Board& board, int limit);
+long long dlxEnumerate(DlxSolver& dlx, const Board& board,
+                       const std::function<bool(const Board&)>& visit);
+
+#endif
@@ -0,0 +1,139 @@
+#include "frame_scheduler.h"
+#include <algorithm>
+#include <iostream>
+#include "perf_trace.h"
+
+using namespace std;
+
+
+const Uint32 STATS_INTERVAL_MS = 1000;
+
+static bool reached(Uint32 now, Uint32 deadline) {
+    return (Sint32)(now - deadline) >= 0;
+}
+
+void initFrameScheduler(FrameScheduler& frames, int fpsCap, bool reportStats) {
+    frames = FrameScheduler();
+    frames.minFrameMs = fpsCap > 0 ? 1000 / fpsCap : 0;
+    frames.reportStats = reportStats;
+    frames.lastFrame = SDL_GetTicks() - frames.minFrameMs;
+    frames.reportAt = SDL_GetTicks() + STATS_INTERVAL_MS;
+}
+
+void requestRedraw(FrameScheduler& frames) {
+    frames.redraw = true;
+}
+
+void setFrameTick(FrameScheduler& frames, Uint32 at) {
+    frames.nextTick = at;
+    frames.hasTick = true;
+}
+
+void clearFrameTick(FrameScheduler& frames) {
+    frames.hasTick = false;
+}
+
+bool waitFrameEvent(FrameScheduler& frames, SDL_Event& event) {
+    Uint32 now = SDL_GetTicks();
+    bool hasDeadline = false;
+    Uint32 deadline = 0;
+
+    if (frames.redraw) {
+        deadline = frames.lastFrame + frames.minFrameMs;
+        hasDeadline = true;
+    }
+    if (frames.hasTick && (!hasDeadline || (Sint32)(frames.nextTick - deadline) < 0)) {
+        deadline = frames.nextTick;
+        hasDeadline = true;
+    }
+
+    if (!hasDeadline) {
+        return SDL_WaitEvent(&event) != 0;
+    }
+    if (reached(now, deadline)) {
+        if (frames.hasTick && reached(now, frames.nextTick)) frames.hasTick = false;
+        return SDL_PollEvent(&event) != 0;
+    }
+    bool gotEvent = SDL_WaitEventTimeout(&event, (int)(deadline - now)) != 0;
+    if (frames.hasTick && reached(SDL_GetTicks(), frames.nextTick)) frames.hasTick = false;
+    return gotEvent;
+}
+
+bool frameDue(const FrameScheduler& frames) {
+    return frames.redraw && reached(SDL_GetTicks(), frames.lastFrame + frames.minFrameMs);
+}
+
+void beginFrame(FrameScheduler& frames) {
+    frames.frameStart = SDL_GetPerformanceCounter();
+    frames.frameTextures = takeTextureAllocations();
+    frames.lastFrame = SDL_GetTicks();
+    frames.redraw = false;
+}
+
+void endFrame(FrameScheduler& frames) {
+    double micros = (double)(SDL_GetPerformanceCounter() - frames.frameStart) * 1e6
+                  / (double)SDL_GetPerformanceFrequency();
+    frames.windowFrames++;
+    frames.windowMicros += micros;
+    if (micros > frames.windowMaxMicros) frames.windowMaxMicros = micros;
+    frames.totalFrames++;
+    frames.totalMicros += micros;
+    if (micros > frames.maxMicros) frames.maxMicros = micros;
+    frames.cpuHistory[frames.historyNext] = (float)micros;
+    frames.presentHistory[frames.historyNext] = 0;
+    frames.historyNext = (frames.historyNext + 1) % FRAME_HISTORY;
+    if (frames.historyCount < FRAME_HISTORY) frames.historyCount++;
+
+    Uint32 now = SDL_GetTicks();
+    if (!reached(now, frames.reportAt)) return;
+    if (frames.reportStats) {
+        cerr << "Khung hinh: " << frames.windowFrames << ", CPU trung binh "
+             << frames.windowMicros / frames.windowFrames << " us, lau nhat "
+             << frames.windowMaxMicros << " us" << endl;
+    }
+    frames.windowFrames = 0;
+    frames.windowMicros = 0;
+    frames.windowMaxMicros = 0;
+    frames.reportAt = now + STATS_INTERVAL_MS;
+}
+
+void presentFrame(FrameScheduler& frames, SDL_Renderer* renderer) {
+    TRACE_SCOPE("SDL_RenderPresent");
+    Uint64 start = SDL_GetPerformanceCounter();
+    SDL_RenderPresent(renderer);
+    double micros = (double)(SDL_GetPerformanceCounter() - start) * 1e6 / (double)SDL_GetPerformanceFrequency();
+    int last = (frames.historyNext + FRAME_HISTORY - 1) % FRAME_HISTORY;
+    frames.presentHistory[last] = (float)micros;
+}
+
+static double percentile(float* sorted, int count, int percent) {
+    return sorted[(count - 1) * percent / 100] / 1000.0;
+}
+
+FrameSummary summarizeFrames(const FrameScheduler& frames) {
+    FrameSummary summary = {};
+    int count = frames.historyCount;
+    summary.frames = count;
+    summary.textures = frames.frameTextures;
+    if (count == 0) return summary;
+
+    float sorted[FRAME_HISTORY];
+    copy(frames.cpuHistory, frames.cpuHistory + count, sorted);
+    sort(sorted, sorted + count);
+    summary.cpuP50 = percentile(sorted, count, 50);
+    summary.cpuP95 = percentile(sorted, count, 95);
+    summary.cpuP99 = percentile(sorted, count, 99);
+    summary.cpuMax = sorted[count - 1] / 1000.0;
+
+    copy(frames.presentHistory, frames.presentHistory + count, sorted);
+    sort(sorted, sorted + count);
+    summary.presentP50 = percentile(sorted, count, 50);
+    summary.presentP99 = percentile(sorted, count, 99);
+    return summary;
+}
+
+void printFrameStats(const FrameScheduler& frames) {
+    if (!frames.reportStats || frames.totalFrames == 0) return;
+    cerr << "Tong so khung hinh: " << frames.totalFrames << ", CPU trung binh "
+         << frames.totalMicros / frames.totalFrames << " us, lau nhat " << frames.maxMicros << " us" << endl;
+}
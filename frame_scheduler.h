@@ -0,0 +1,69 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <SDL.h>
+
+const int FRAME_HISTORY = 120;
+
+// Blocks on SDL_WaitEventTimeout instead of spinning on vsync. The loop only
+// wakes for input, for a pending tick (the once-per-second timer) or for a
+// redraw that the FPS cap has held back; an idle screen costs no CPU.
+struct FrameScheduler {
+    Uint32 minFrameMs = 0;
+    Uint32 lastFrame = 0;
+    Uint32 nextTick = 0;
+    bool hasTick = false;
+    bool redraw = true;
+
+    Uint64 frameStart = 0;
+    bool reportStats = false;
+    Uint32 reportAt = 0;
+    long long windowFrames = 0;
+    double windowMicros = 0;
+    double windowMaxMicros = 0;
+    long long totalFrames = 0;
+    double totalMicros = 0;
+    double maxMicros = 0;
+
+    // The last FRAME_HISTORY frames for the overlay: CPU time, time blocked
+    // in SDL_RenderPresent, and textures created since the previous frame.
+    float cpuHistory[FRAME_HISTORY] = {};
+    float presentHistory[FRAME_HISTORY] = {};
+    int historyNext = 0;
+    int historyCount = 0;
+    int frameTextures = 0;
+};
+
+struct FrameSummary {
+    int frames;
+    double cpuP50, cpuP95, cpuP99, cpuMax;
+    double presentP50, presentP99;
+    int textures;
+};
+
+// fpsCap <= 0 means no cap beyond vsync.
+void initFrameScheduler(FrameScheduler& frames, int fpsCap, bool reportStats);
+
+// Animations call this every frame they need another one.
+void requestRedraw(FrameScheduler& frames);
+// Wake at `at` (SDL_GetTicks time) even without input; replaces the previous tick.
+void setFrameTick(FrameScheduler& frames, Uint32 at);
+void clearFrameTick(FrameScheduler& frames);
+
+// Waits for the next event or deadline. Returns true with `event` filled in,
+// false when the wait ended on a deadline.
+bool waitFrameEvent(FrameScheduler& frames, SDL_Event& event);
+bool frameDue(const FrameScheduler& frames);
+
+// CPU time is measured between these two, so the vsync wait in
+// SDL_RenderPresent is not counted.
+void beginFrame(FrameScheduler& frames);
+void endFrame(FrameScheduler& frames);
+// SDL_RenderPresent, timed on its own; a long present is a vsync wait or a
+// driver stall rather than our own work.
+void presentFrame(FrameScheduler& frames, SDL_Renderer* renderer);
+// Times are in milliseconds.
+FrameSummary summarizeFrames(const FrameScheduler& frames);
+void printFrameStats(const FrameScheduler& frames);
+
+#endif
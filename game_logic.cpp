@@ -0,0 +1,362 @@
+#include "game_logic.h"
+#include <algorithm>
+#include <cstring>
+#include "board_layout.h"
+#include "perf_trace.h"
+
+using namespace std;
+
+
+void initGameSession(GameSession& session, uint64_t seed) {
+    session.solution.clear();
+    session.grid.clear();
+    memset(&session.state, 0, sizeof(session.state));
+    clearUndoJournal(session.undo);
+    session.hintShown = false;
+    session.gameState = MENU;
+    session.pauseSelection = RESUME;
+    session.selectedRow = -1;
+    session.selectedCol = -1;
+    session.triesLeft = MAX_TRIES;
+    session.timeLeft = GAME_DURATION;
+    session.startTime = 0;
+    session.pauseStartTime = 0;
+    session.totalPausedTime = 0;
+    session.difficulty = MEDIUM;
+    session.symmetry = SYMMETRY_ROTATIONAL;
+    session.puzzle = {0, false};
+    session.menuItemHeight = DEFAULT_MENU_ITEM_HEIGHT;
+    seedRng(session.rng, seed);
+    session.bank = nullptr;
+    session.pool = nullptr;
+    session.saver = nullptr;
+    session.scripted.clear();
+}
+
+uint32_t elapsedPlayMs(const GameSession& session, uint32_t now) {
+    if (session.gameState == PAUSED) now = session.pauseStartTime;
+    return now - session.startTime - session.totalPausedTime;
+}
+
+// The copy is the only work done here; packing and writing happen on the
+// save thread.
+void saveGame(GameSession& session, uint32_t now) {
+    if (session.saver == nullptr) return;
+
+    TRACE_SCOPE("saveGame");
+    GameSnapshot snapshot;
+    snapshot.solution = session.solution;
+    snapshot.grid = session.grid;
+    memcpy(snapshot.pencil, session.state.pencil, sizeof(snapshot.pencil));
+    snapshot.puzzleId = session.puzzle.id;
+    snapshot.elapsedMs = elapsedPlayMs(session, now);
+    snapshot.triesLeft = session.triesLeft;
+    snapshot.difficulty = session.difficulty;
+    snapshot.fromBank = session.puzzle.fromBank;
+    snapshot.finished = session.gameState == WIN || session.gameState == GAME_OVER;
+    queueSnapshot(*session.saver, snapshot);
+}
+
+static void journalMove(GameSession& session, MoveRecord& move, uint32_t now) {
+    if (session.saver == nullptr) return;
+
+    move.elapsedMs = elapsedPlayMs(session, now);
+    move.triesLeft = (uint8_t)session.triesLeft;
+    queueMove(*session.saver, move);
+    if (snapshotDue(*session.saver)) saveGame(session, now);
+}
+
+static void makeMove(GameSession& session, MoveRecord move, uint32_t now) {
+    applyMove(session.state, session.grid, move, true);
+    pushUndoMove(session.undo, move);
+    journalMove(session, move, now);
+    session.hintShown = false;
+}
+
+static void beginPlay(GameSession& session, uint32_t startTime) {
+    session.hintShown = false;
+    session.gameState = RUNNING;
+    session.selectedRow = -1;
+    session.selectedCol = -1;
+    session.startTime = startTime;
+    session.totalPausedTime = 0;
+}
+
+// A scripted puzzle comes first, then the bank, then the pool; the last
+// resort is generating one here from the session's own seed sequence.
+static void choosePuzzle(GameSession& session) {
+    if (!session.scripted.empty()) {
+        PuzzleChoice choice = session.scripted.front();
+        session.scripted.pop_front();
+        session.puzzle = choice;
+        if (choice.fromBank && session.bank != nullptr
+            && loadBankPuzzle(*session.bank, session.difficulty, choice.id, session.solution, session.grid)) {
+            return;
+        }
+        session.puzzle.fromBank = false;
+        generatePuzzleFromSeed(choice.id, session.difficulty, session.symmetry, session.solution, session.grid);
+        return;
+    }
+
+    uint64_t bankCount = session.bank != nullptr ? bankPuzzleCount(*session.bank, session.difficulty) : 0;
+    uint64_t bankIndex = bankCount > 0 ? nextRandom(session.rng) % bankCount : 0;
+    session.puzzle.fromBank = bankCount > 0
+        && loadBankPuzzle(*session.bank, session.difficulty, bankIndex, session.solution, session.grid);
+    if (session.puzzle.fromBank) {
+        session.puzzle.id = bankIndex;
+    } else if (session.pool == nullptr
+               || !popPuzzle(*session.pool, session.difficulty, session.solution, session.grid, session.puzzle.id)) {
+        session.puzzle.id = nextRandom(session.rng);
+        generatePuzzleFromSeed(session.puzzle.id, session.difficulty, session.symmetry, session.solution,
+                               session.grid);
+    }
+}
+
+unsigned startNewGame(GameSession& session, uint32_t now) {
+    TRACE_SCOPE("resetGame");
+    choosePuzzle(session);
+    initBoardState(session.state, session.grid);
+    clearUndoJournal(session.undo);
+    session.triesLeft = MAX_TRIES;
+    session.timeLeft = GAME_DURATION;
+    beginPlay(session, now);
+    saveGame(session, now);
+    return EFFECT_NEW_PUZZLE | EFFECT_MUSIC_START | EFFECT_STATE_CHANGED;
+}
+
+unsigned restoreGame(GameSession& session, const GameSnapshot& saved, const vector<MoveRecord>& moves,
+                     uint32_t now) {
+    session.solution = saved.solution;
+    session.grid = saved.grid;
+    initBoardState(session.state, session.grid);
+    memcpy(session.state.pencil, saved.pencil, sizeof(session.state.pencil));
+    clearUndoJournal(session.undo);
+    uint32_t elapsedMs = saved.elapsedMs;
+    session.triesLeft = saved.triesLeft;
+    for (const MoveRecord& move : moves) {
+        replayMove(session.undo, session.state, session.grid, move);
+        elapsedMs = move.elapsedMs;
+        session.triesLeft = move.triesLeft;
+    }
+    session.difficulty = saved.difficulty;
+    session.puzzle = {saved.puzzleId, saved.fromBank};
+    session.timeLeft = GAME_DURATION - (int)(elapsedMs / 1000);
+    beginPlay(session, now - elapsedMs);
+    // Folds the replayed records into a fresh save and starts a clean journal.
+    saveGame(session, now);
+    return EFFECT_NEW_PUZZLE | EFFECT_MUSIC_START | EFFECT_STATE_CHANGED;
+}
+
+bool hitTestCell(int x, int y, int& row, int& col) {
+    if (x < 0 || y < GAME_AREA_Y_OFFSET || y >= SCREEN_HEIGHT) return false;
+    col = min(x / CELL_SIZE, GRID_SIZE - 1);
+    row = min((y - GAME_AREA_Y_OFFSET) / CELL_SIZE, GRID_SIZE - 1);
+    return true;
+}
+
+int hitTestPauseMenu(const GameSession& session, int x, int y) {
+    int left = (SCREEN_WIDTH - PAUSE_MENU_WIDTH) / 2;
+    if (x < left || x >= left + PAUSE_MENU_WIDTH) return -1;
+    for (int item = RESUME; item <= QUIT; item++) {
+        int top = PAUSE_MENU_Y + item * PAUSE_MENU_SPACING;
+        if (y >= top && y < top + session.menuItemHeight) return item;
+    }
+    return -1;
+}
+
+static unsigned resumeGame(GameSession& session, uint32_t now) {
+    session.gameState = RUNNING;
+    session.totalPausedTime += now - session.pauseStartTime;
+    return EFFECT_MUSIC_RESUME | EFFECT_STATE_CHANGED;
+}
+
+static unsigned pickPauseItem(GameSession& session, int item, uint32_t now) {
+    switch (item) {
+        case RESUME:
+            return resumeGame(session, now);
+        case RESTART:
+            return startNewGame(session, now);
+        case QUIT:
+            return EFFECT_MUSIC_STOP | EFFECT_QUIT;
+        default:
+            return 0;
+    }
+}
+
+static unsigned enterDigit(GameSession& session, int number, bool pencil, uint32_t now) {
+    int row = session.selectedRow;
+    int col = session.selectedCol;
+    if (row == -1 || col == -1 || session.grid.isGiven(row, col)) return 0;
+
+    int cell = row * GRID_SIZE + col;
+    if (pencil) {
+        // Pencil marks cost no tries.
+        if (session.grid.get(row, col) == 0) {
+            uint16_t marks = session.state.pencil[cell] ^ (uint16_t)(1 << (number - 1));
+            makeMove(session, describePencilMove(session.state, session.grid, cell, marks), now);
+        }
+        return 0;
+    }
+    if (session.solution.get(row, col) == number) {
+        if (session.grid.cells[cell] != number) {
+            makeMove(session, describeDigitMove(session.state, session.grid, cell, number), now);
+        }
+        return EFFECT_SOUND_CORRECT;
+    }
+    if (session.grid.get(row, col) == number) return 0;
+
+    session.triesLeft--;
+    MoveRecord mistake = describeDigitMove(session.state, session.grid, cell, session.grid.cells[cell]);
+    mistake.type = MOVE_MISTAKE;
+    journalMove(session, mistake, now);
+    return EFFECT_SOUND_WRONG;
+}
+
+static void eraseCell(GameSession& session, uint32_t now) {
+    int row = session.selectedRow;
+    int col = session.selectedCol;
+    if (row == -1 || col == -1 || session.grid.isGiven(row, col)) return;
+
+    int cell = row * GRID_SIZE + col;
+    if (session.grid.cells[cell] != 0) {
+        makeMove(session, describeDigitMove(session.state, session.grid, cell, 0), now);
+    } else if (session.state.pencil[cell] != 0) {
+        makeMove(session, describePencilMove(session.state, session.grid, cell, 0), now);
+    }
+}
+
+static void undoOrRedo(GameSession& session, bool redo, uint32_t now) {
+    MoveRecord move;
+    if (!(redo ? redoMove(session.undo, move) : undoMove(session.undo, move))) return;
+
+    applyMove(session.state, session.grid, move, redo);
+    move.type = redo ? MOVE_REDO : MOVE_UNDO;
+    journalMove(session, move, now);
+    session.hintShown = false;
+    session.selectedRow = move.cell / GRID_SIZE;
+    session.selectedCol = move.cell % GRID_SIZE;
+}
+
+static unsigned handleRunningInput(GameSession& session, const GameInput& input, uint32_t now) {
+    switch (input.type) {
+        case INPUT_PAUSE:
+        case INPUT_BACK:
+            session.gameState = PAUSED;
+            session.pauseStartTime = now;
+            session.pauseSelection = RESUME;
+            saveGame(session, now);
+            return EFFECT_MUSIC_PAUSE | EFFECT_STATE_CHANGED;
+        case INPUT_UNDO:
+        case INPUT_REDO:
+            undoOrRedo(session, input.type == INPUT_REDO, now);
+            return 0;
+        case INPUT_UP:
+            session.selectedRow = session.selectedRow > 0 ? session.selectedRow - 1 : GRID_SIZE - 1;
+            return 0;
+        case INPUT_DOWN:
+            session.selectedRow = session.selectedRow < GRID_SIZE - 1 ? session.selectedRow + 1 : 0;
+            return 0;
+        case INPUT_LEFT:
+            session.selectedCol = session.selectedCol > 0 ? session.selectedCol - 1 : GRID_SIZE - 1;
+            return 0;
+        case INPUT_RIGHT:
+            session.selectedCol = session.selectedCol < GRID_SIZE - 1 ? session.selectedCol + 1 : 0;
+            return 0;
+        case INPUT_HINT:
+            // The hinted cell becomes the selection, so it gets the usual highlight.
+            session.hintShown = findHint(session.grid, session.hint);
+            if (session.hintShown) {
+                session.selectedRow = session.hint.cell / GRID_SIZE;
+                session.selectedCol = session.hint.cell % GRID_SIZE;
+            }
+            return 0;
+        case INPUT_DIGIT:
+        case INPUT_PENCIL:
+            if (input.value < 1 || input.value > GRID_SIZE) return 0;
+            return enterDigit(session, input.value, input.type == INPUT_PENCIL, now);
+        case INPUT_ERASE:
+            eraseCell(session, now);
+            return 0;
+        case INPUT_CLICK:
+            if (input.value == 1) hitTestCell(input.x, input.y, session.selectedRow, session.selectedCol);
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+static unsigned handlePausedInput(GameSession& session, const GameInput& input, uint32_t now) {
+    switch (input.type) {
+        case INPUT_UP:
+            session.pauseSelection = (PauseMenuSelection)((session.pauseSelection - 1 + 3) % 3);
+            return 0;
+        case INPUT_DOWN:
+            session.pauseSelection = (PauseMenuSelection)((session.pauseSelection + 1) % 3);
+            return 0;
+        case INPUT_CONFIRM:
+            return pickPauseItem(session, session.pauseSelection, now);
+        case INPUT_PAUSE:
+        case INPUT_BACK:
+            return resumeGame(session, now);
+        case INPUT_RESTART:
+            return startNewGame(session, now);
+        case INPUT_QUIT:
+            return EFFECT_MUSIC_STOP | EFFECT_QUIT;
+        case INPUT_CLICK:
+            return pickPauseItem(session, hitTestPauseMenu(session, input.x, input.y), now);
+        default:
+            return 0;
+    }
+}
+
+unsigned handleGameInput(GameSession& session, const GameInput& input, uint32_t now) {
+    switch (session.gameState) {
+        case RUNNING:
+            return handleRunningInput(session, input, now);
+        case PAUSED:
+            return handlePausedInput(session, input, now);
+        case GAME_OVER:
+        case WIN:
+            if (input.type == INPUT_RESTART || input.type == INPUT_CLICK) return startNewGame(session, now);
+            if (input.type == INPUT_QUIT || input.type == INPUT_BACK) return EFFECT_QUIT;
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+unsigned updateGameClock(GameSession& session, uint32_t now) {
+    if (session.gameState != RUNNING) return 0;
+
+    unsigned effects = 0;
+    int timeLeft = GAME_DURATION - (int)(elapsedPlayMs(session, now) / 1000);
+    if (timeLeft != session.timeLeft) effects |= EFFECT_CLOCK_TICK;
+    session.timeLeft = timeLeft;
+
+    if (session.timeLeft <= 0) {
+        session.timeLeft = 0;
+        session.gameState = GAME_OVER;
+    }
+    if (session.triesLeft <= 0) session.gameState = GAME_OVER;
+    if (boardComplete(session.state)) session.gameState = WIN;
+    if (session.gameState != RUNNING) {
+        saveGame(session, now);
+        effects |= EFFECT_MUSIC_STOP | EFFECT_STATE_CHANGED;
+    }
+    return effects;
+}
+
+uint64_t hashGameSession(const GameSession& session) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ull;
+    };
+    mix(session.grid.cells, sizeof(session.grid.cells));
+    mix(session.state.pencil, sizeof(session.state.pencil));
+    mix(&session.puzzle.id, sizeof(session.puzzle.id));
+    int32_t fields[] = {session.gameState, session.triesLeft, session.selectedRow, session.selectedCol,
+                        session.pauseSelection, (int32_t)session.undo.cursor, (int32_t)session.undo.moves.size()};
+    mix(fields, sizeof(fields));
+    return hash;
+}
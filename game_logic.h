@@ -0,0 +1,133 @@
+#ifndef GAME_LOGIC_H
+#define GAME_LOGIC_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "board_state.h"
+#include "generator.h"
+#include "grader.h"
+#include "puzzle_bank.h"
+#include "puzzle_pool.h"
+#include "rng.h"
+#include "save_game.h"
+
+const int GAME_DURATION = 1800;
+const int MAX_TRIES = 5;
+
+enum GameState {
+    MENU,
+    RUNNING,
+    PAUSED,
+    GAME_OVER,
+    WIN
+};
+
+enum PauseMenuSelection {
+    RESUME,
+    RESTART,
+    QUIT
+};
+
+// What an SDL event means to the game, so the state machine below runs the
+// same with a window, from a recording or from a random input stream.
+enum InputType {
+    INPUT_UP,
+    INPUT_DOWN,
+    INPUT_LEFT,
+    INPUT_RIGHT,
+    INPUT_DIGIT,    // value is the digit
+    INPUT_PENCIL,   // value is the digit
+    INPUT_ERASE,
+    INPUT_PAUSE,    // P
+    INPUT_BACK,     // ESC
+    INPUT_CONFIRM,  // ENTER
+    INPUT_RESTART,  // R
+    INPUT_QUIT,     // Q
+    INPUT_HINT,
+    INPUT_UNDO,
+    INPUT_REDO,
+    INPUT_CLICK,    // value is 1 for the left button, 0 for any other
+    INPUT_TYPE_COUNT
+};
+
+struct GameInput {
+    uint8_t type;
+    uint8_t value;
+    int16_t x;
+    int16_t y;
+};
+
+// Side effects the caller carries out; handleGameInput and the others return
+// a mask of these.
+enum GameEffect {
+    EFFECT_SOUND_CORRECT = 1 << 0,
+    EFFECT_SOUND_WRONG = 1 << 1,
+    EFFECT_MUSIC_START = 1 << 2,
+    EFFECT_MUSIC_PAUSE = 1 << 3,
+    EFFECT_MUSIC_RESUME = 1 << 4,
+    EFFECT_MUSIC_STOP = 1 << 5,
+    EFFECT_NEW_PUZZLE = 1 << 6,
+    EFFECT_CLOCK_TICK = 1 << 7,
+    EFFECT_STATE_CHANGED = 1 << 8,
+    EFFECT_QUIT = 1 << 9
+};
+
+struct PuzzleChoice {
+    uint64_t id;
+    bool fromBank;
+};
+
+// One game with everything the event handlers touch. Times are milliseconds
+// on whatever clock the caller passes as `now`. The bank, pool and save
+// writer are optional; without the pool and bank puzzles are generated from
+// `rng`, and without the writer nothing is saved.
+struct GameSession {
+    Board solution;
+    Board grid;
+    BoardState state;
+    UndoJournal undo;
+    Hint hint;
+    bool hintShown;
+    GameState gameState;
+    PauseMenuSelection pauseSelection;
+    int selectedRow;
+    int selectedCol;
+    int triesLeft;
+    int timeLeft;
+    uint32_t startTime;
+    uint32_t pauseStartTime;
+    uint32_t totalPausedTime;
+    Difficulty difficulty;
+    HoleSymmetry symmetry;
+    PuzzleChoice puzzle;
+    int menuItemHeight;
+    Rng rng;
+    PuzzleBank* bank;
+    PuzzlePool* pool;
+    SaveWriter* saver;
+    // Puzzles to use before any other source, in order; a replay fills it so
+    // the recorded games get the recorded puzzles.
+    std::deque<PuzzleChoice> scripted;
+};
+
+void initGameSession(GameSession& session, uint64_t seed);
+// Starts a new game (resetGame in the event loop) with the next puzzle.
+unsigned startNewGame(GameSession& session, uint32_t now);
+// Continues a loaded save; `moves` are the journal records made after it.
+unsigned restoreGame(GameSession& session, const GameSnapshot& saved, const std::vector<MoveRecord>& moves,
+                     uint32_t now);
+unsigned handleGameInput(GameSession& session, const GameInput& input, uint32_t now);
+// Runs the timer and the win and loss checks; called once per loop pass
+// after the events.
+unsigned updateGameClock(GameSession& session, uint32_t now);
+// Queues a snapshot on the save writer, if there is one.
+void saveGame(GameSession& session, uint32_t now);
+uint32_t elapsedPlayMs(const GameSession& session, uint32_t now);
+bool hitTestCell(int x, int y, int& row, int& col);
+// Returns the pause menu item under the point, or -1.
+int hitTestPauseMenu(const GameSession& session, int x, int y);
+// Changes whenever anything a replay should reproduce differs.
+uint64_t hashGameSession(const GameSession& session);
+
+#endif
@@ -0,0 +1,261 @@
+#include "generator.h"
+#include "perf_trace.h"
+#include "solver.h"
+
+using namespace std;
+
+
+const int MAX_HOLES = 64;
+const int RATING_ATTEMPTS = 16;
+// Node budget per uniqueness check, in nodes per cell. A check that runs out
+// keeps the cell, so the puzzle stays unique either way.
+const int64_t CARVE_NODE_BUDGET = 8;
+
+template <int BOX>
+bool isSafe(const BasicBoard<BOX>& board, int row, int col, int num) {
+
+    for (int x = 0; x < BOX * BOX; x++) {
+        if (board.get(row, x) == num || board.get(x, col) == num)
+            return false;
+    }
+
+
+    int startRow = row - row % BOX;
+    int startCol = col - col % BOX;
+    for (int i = startRow; i < startRow + BOX; i++) {
+        for (int j = startCol; j < startCol + BOX; j++) {
+
+            if (board.get(i, j) == num)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+template <int BOX>
+bool solveSudoku(BasicBoard<BOX>& board, Rng& rng) {
+    for (int row = 0; row < BOX * BOX; row++) {
+        for (int col = 0; col < BOX * BOX; col++) {
+            if (board.get(row, col) == 0) {
+                 int numbers[BOX * BOX];
+                 for (int i = 0; i < BOX * BOX; i++) numbers[i] = i + 1;
+                 shuffleArray(numbers, BOX * BOX, rng);
+                 for (int number : numbers) {
+                    if (isSafe(board, row, col, number)) {
+                        board.set(row, col, number);
+                        if (solveSudoku(board, rng)) {
+                            return true;
+                        } else {
+                            board.set(row, col, 0);
+                        }
+                    }
+                }
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <int BOX>
+void buildSudoku(BasicBoard<BOX>& board, Rng& rng) {
+    TRACE_SCOPE("buildSudoku");
+    board.clear();
+
+#ifdef SUDOKU_REFERENCE_SOLVER
+    solveSudoku(board, rng);
+#else
+    fillSudokuRandom(board, rng);
+#endif
+}
+
+int givensFor(Difficulty difficulty, int cells) {
+    int givens;
+    switch (difficulty) {
+        case EASY:
+            givens = 50;
+            break;
+        case HARD:
+            givens = 30;
+            break;
+        default:
+            givens = 40;
+            break;
+    }
+    return givens * cells / BOARD_CELLS;
+}
+
+RatingBand ratingBandFor(Difficulty difficulty) {
+    switch (difficulty) {
+        case EASY:
+            return {0, techniqueRating(TECH_HIDDEN_SINGLE)};
+        case HARD:
+            return {techniqueRating(TECH_NAKED_PAIR), techniqueRating(TECH_SIMPLE_COLORING)};
+        default:
+            return {techniqueRating(TECH_NAKED_SINGLE), techniqueRating(TECH_CLAIMING)};
+    }
+}
+
+template <int BOX>
+static int partnerOf(int cell, HoleSymmetry symmetry) {
+    const int size = BOX * BOX;
+    switch (symmetry) {
+        case SYMMETRY_ROTATIONAL:
+            return size * size - 1 - cell;
+        case SYMMETRY_MIRROR:
+            return (cell / size) * size + (size - 1 - cell % size);
+        default:
+            return cell;
+    }
+}
+
+// The puzzle was unique before the removal, so any second solution must
+// change one of the two cleared cells.
+template <int BOX>
+static bool staysUnique(const BasicBoard<BOX>& puzzle, int cell, int partner, const BasicBoard<BOX>& solution,
+                        int64_t nodeBudget) {
+    BasicMaskSolver<BOX> solver;
+    initMaskSolver(solver, puzzle);
+    solver.nodesLeft = nodeBudget;
+
+    int digit = solution.cells[cell];
+    if (hasSolutionWithout(solver, cell, digit)) return false;
+    if (partner == cell) return true;
+
+    setCell(solver, cell, digit);
+    return !hasSolutionWithout(solver, partner, solution.cells[partner]);
+}
+
+template <int BOX>
+int carvePuzzle(const BasicBoard<BOX>& solution, BasicBoard<BOX>& puzzle, int holesToMake,
+                HoleSymmetry symmetry, Rng& rng) {
+    TRACE_SCOPE("carvePuzzle");
+    const int cells = BoardGeometry<BOX>::CELLS;
+    puzzle = solution;
+
+    int order[cells];
+    for (int i = 0; i < cells; i++) order[i] = i;
+    shuffleArray(order, cells, rng);
+
+    int holesMade = 0;
+    for (int i = 0; i < cells && holesMade < holesToMake; i++) {
+        int cell = order[i];
+        int partner = partnerOf<BOX>(cell, symmetry);
+        if (puzzle.cells[cell] == 0) continue;
+
+        int removed = (partner == cell || puzzle.cells[partner] == 0) ? 1 : 2;
+        if (holesMade + removed > holesToMake) continue;
+
+        puzzle.cells[cell] = 0;
+        puzzle.cells[partner] = 0;
+        if (staysUnique(puzzle, cell, partner, solution, CARVE_NODE_BUDGET * cells)) {
+            holesMade += removed;
+        } else {
+            puzzle.cells[cell] = solution.cells[cell];
+            puzzle.cells[partner] = solution.cells[partner];
+        }
+    }
+
+    markGivens(puzzle);
+    refreshCandidates(puzzle);
+    return holesMade;
+}
+
+int carvePuzzleRated(const Board& solution, Board& puzzle, int holesToMake, RatingBand band,
+                     HoleSymmetry symmetry, Rng& rng, GradeResult& grade) {
+    TRACE_SCOPE("carvePuzzleRated");
+    puzzle = solution;
+    gradePuzzle(puzzle, grade);
+
+    int order[BOARD_CELLS];
+    for (int i = 0; i < BOARD_CELLS; i++) order[i] = i;
+    shuffleArray(order, BOARD_CELLS, rng);
+
+    int holesMade = 0;
+    GradeResult candidate;
+    for (int i = 0; i < BOARD_CELLS; i++) {
+        if (holesMade >= holesToMake && grade.rating >= band.minRating) break;
+
+        int cell = order[i];
+        int partner = partnerOf<BOX_SIZE>(cell, symmetry);
+        if (puzzle.cells[cell] == 0) continue;
+
+        int removed = (partner == cell || puzzle.cells[partner] == 0) ? 1 : 2;
+        if (holesMade + removed > MAX_HOLES) continue;
+
+        puzzle.cells[cell] = 0;
+        puzzle.cells[partner] = 0;
+        if (staysUnique(puzzle, cell, partner, solution, -1) && gradePuzzle(puzzle, candidate)
+            && candidate.rating <= band.maxRating) {
+            holesMade += removed;
+            grade = candidate;
+        } else {
+            puzzle.cells[cell] = solution.cells[cell];
+            puzzle.cells[partner] = solution.cells[partner];
+        }
+    }
+
+    markGivens(puzzle);
+    refreshCandidates(puzzle);
+    return holesMade;
+}
+
+static int bandDistance(int rating, RatingBand band) {
+    if (rating < band.minRating) return band.minRating - rating;
+    if (rating > band.maxRating) return rating - band.maxRating;
+    return 0;
+}
+
+void generatePuzzle(Difficulty difficulty, HoleSymmetry symmetry, Rng& rng,
+                    Board& solution, Board& puzzle, GradeResult* grade) {
+    TRACE_SCOPE("generatePuzzle");
+    int holesToMake = BOARD_CELLS - givensFor(difficulty);
+    if (holesToMake < 10) holesToMake = 10;
+    if (holesToMake > 60) holesToMake = 60;
+    RatingBand band = ratingBandFor(difficulty);
+
+    Board triedSolution;
+    Board triedPuzzle;
+    GradeResult triedGrade;
+    int bestDistance = -1;
+    for (int attempt = 0; attempt < RATING_ATTEMPTS && bestDistance != 0; attempt++) {
+        buildSudoku(triedSolution, rng);
+        carvePuzzleRated(triedSolution, triedPuzzle, holesToMake, band, symmetry, rng, triedGrade);
+
+        int distance = bandDistance(triedGrade.rating, band);
+        if (bestDistance < 0 || distance < bestDistance) {
+            bestDistance = distance;
+            solution = triedSolution;
+            puzzle = triedPuzzle;
+            if (grade != nullptr) *grade = triedGrade;
+        }
+    }
+}
+
+void generatePuzzleFromSeed(uint64_t seed, Difficulty difficulty, HoleSymmetry symmetry,
+                            Board& solution, Board& puzzle, GradeResult* grade) {
+    Rng rng;
+    seedRng(rng, seed);
+    generatePuzzle(difficulty, symmetry, rng, solution, puzzle, grade);
+}
+
+template <int BOX>
+void generateSizedPuzzle(Difficulty difficulty, HoleSymmetry symmetry, Rng& rng,
+                         BasicBoard<BOX>& solution, BasicBoard<BOX>& puzzle) {
+    const int cells = BoardGeometry<BOX>::CELLS;
+    buildSudoku(solution, rng);
+    carvePuzzle(solution, puzzle, cells - givensFor(difficulty, cells), symmetry, rng);
+}
+
+#define INSTANTIATE_GENERATOR(BOX) \
+    template bool isSafe<BOX>(const BasicBoard<BOX>&, int, int, int); \
+    template bool solveSudoku<BOX>(BasicBoard<BOX>&, Rng&); \
+    template void buildSudoku<BOX>(BasicBoard<BOX>&, Rng&); \
+    template int carvePuzzle<BOX>(const BasicBoard<BOX>&, BasicBoard<BOX>&, int, HoleSymmetry, Rng&); \
+    template void generateSizedPuzzle<BOX>(Difficulty, HoleSymmetry, Rng&, BasicBoard<BOX>&, BasicBoard<BOX>&);
+
+INSTANTIATE_GENERATOR(2)
+INSTANTIATE_GENERATOR(3)
+INSTANTIATE_GENERATOR(4)
+INSTANTIATE_GENERATOR(5)
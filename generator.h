@@ -0,0 +1,63 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "board.h"
+#include "grader.h"
+#include "rng.h"
+
+enum Difficulty {
+    EASY,
+    MEDIUM,
+    HARD,
+    DIFFICULTY_COUNT
+};
+
+enum HoleSymmetry {
+    SYMMETRY_NONE,
+    SYMMETRY_ROTATIONAL,
+    SYMMETRY_MIRROR
+};
+
+// The board-level helpers are instantiated for box edges 2 to 5 in
+// generator.cpp; grading and the rated generator only exist for 9x9.
+template <int BOX>
+bool isSafe(const BasicBoard<BOX>& board, int row, int col, int num);
+template <int BOX>
+bool solveSudoku(BasicBoard<BOX>& board, Rng& rng);
+template <int BOX>
+void buildSudoku(BasicBoard<BOX>& board, Rng& rng);
+// Givens for a 9x9 board, or the same share of a board with `cells` cells.
+int givensFor(Difficulty difficulty, int cells = BOARD_CELLS);
+
+// Inclusive range of grader ratings (tenths) a difficulty should land in.
+struct RatingBand {
+    int minRating;
+    int maxRating;
+};
+
+RatingBand ratingBandFor(Difficulty difficulty);
+
+// Removes up to holesToMake cells from solution, keeping only removals after
+// which the puzzle still has exactly one solution. The cells left are marked
+// as givens. Returns the holes made.
+template <int BOX>
+int carvePuzzle(const BasicBoard<BOX>& solution, BasicBoard<BOX>& puzzle, int holesToMake,
+                HoleSymmetry symmetry, Rng& rng);
+// Like carvePuzzle, but a removal is also undone when the rating would rise
+// above band.maxRating, and carving goes past holesToMake while the rating is
+// still below band.minRating. `grade` describes the returned puzzle.
+int carvePuzzleRated(const Board& solution, Board& puzzle, int holesToMake, RatingBand band,
+                     HoleSymmetry symmetry, Rng& rng, GradeResult& grade);
+// Tries a few solutions and keeps the first puzzle inside the band for
+// `difficulty`, or the closest one.
+void generatePuzzle(Difficulty difficulty, HoleSymmetry symmetry, Rng& rng,
+                    Board& solution, Board& puzzle, GradeResult* grade = nullptr);
+// The same puzzle for the same seed, difficulty and symmetry, everywhere.
+void generatePuzzleFromSeed(uint64_t seed, Difficulty difficulty, HoleSymmetry symmetry,
+                            Board& solution, Board& puzzle, GradeResult* grade = nullptr);
+// Any size, with the hole count as the only difficulty knob.
+template <int BOX>
+void generateSizedPuzzle(Difficulty difficulty, HoleSymmetry symmetry, Rng& rng,
+                         BasicBoard<BOX>& solution, BasicBoard<BOX>& puzzle);
+
+#endif
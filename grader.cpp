@@ -0,0 +1,509 @@
+#include "grader.h"
+#include <cstring>
+
+using namespace std;
+
+
+static const int TECHNIQUE_RATING[TECH_COUNT] = {15, 23, 26, 28, 30, 32, 34, 36, 38, 40, 42, 45};
+static const char* const TECHNIQUE_NAME[TECH_COUNT] = {
+    "Hidden Single", "Naked Single", "Pointing", "Claiming", "Naked Pair", "X-Wing",
+    "Hidden Pair", "Naked Triple", "Swordfish", "Hidden Triple", "XY-Wing", "Simple Coloring"
+};
+
+const int UNITS = 27;
+const uint16_t ALL_CANDIDATES = 0x1FF;
+
+// Units 0-8 are rows, 9-17 columns, 18-26 boxes.
+struct GridTables {
+    uint8_t unitCells[UNITS][GRID_SIZE];
+    uint8_t cellUnits[BOARD_CELLS][3];
+    uint8_t peers[BOARD_CELLS][20];
+
+    GridTables() {
+        for (int i = 0; i < GRID_SIZE; i++) {
+            for (int k = 0; k < GRID_SIZE; k++) {
+                unitCells[i][k] = i * GRID_SIZE + k;
+                unitCells[GRID_SIZE + i][k] = k * GRID_SIZE + i;
+                unitCells[2 * GRID_SIZE + i][k] = ((i / 3) * 3 + k / 3) * GRID_SIZE + (i % 3) * 3 + k % 3;
+            }
+        }
+        for (int cell = 0; cell < BOARD_CELLS; cell++) {
+            int row = cell / GRID_SIZE;
+            int col = cell % GRID_SIZE;
+            cellUnits[cell][0] = row;
+            cellUnits[cell][1] = GRID_SIZE + col;
+            cellUnits[cell][2] = 2 * GRID_SIZE + (row / 3) * 3 + col / 3;
+
+            int count = 0;
+            for (int other = 0; other < BOARD_CELLS; other++) {
+                int otherRow = other / GRID_SIZE;
+                int otherCol = other % GRID_SIZE;
+                bool sameBox = otherRow / 3 == row / 3 && otherCol / 3 == col / 3;
+                if (other != cell && (otherRow == row || otherCol == col || sameBox)) peers[cell][count++] = other;
+            }
+        }
+    }
+};
+
+static const GridTables TABLES;
+
+struct LogicGrid {
+    uint8_t cells[BOARD_CELLS];
+    uint16_t candidates[BOARD_CELLS];
+    int empty;
+    bool broken;
+};
+
+static bool sees(int a, int b) {
+    const uint8_t* ua = TABLES.cellUnits[a];
+    const uint8_t* ub = TABLES.cellUnits[b];
+    return ua[0] == ub[0] || ua[1] == ub[1] || ua[2] == ub[2];
+}
+
+static void place(LogicGrid& grid, int cell, int digit) {
+    uint16_t bit = (uint16_t)(1 << (digit - 1));
+    grid.cells[cell] = (uint8_t)digit;
+    grid.candidates[cell] = 0;
+    grid.empty--;
+    for (int peer : TABLES.peers[cell]) {
+        if (grid.cells[peer] == digit) grid.broken = true;
+        grid.candidates[peer] &= (uint16_t)~bit;
+        if (grid.cells[peer] == 0 && grid.candidates[peer] == 0) grid.broken = true;
+    }
+}
+
+static bool eliminate(LogicGrid& grid, int cell, uint16_t mask) {
+    if (grid.cells[cell] != 0 || !(grid.candidates[cell] & mask)) return false;
+    grid.candidates[cell] &= (uint16_t)~mask;
+    if (grid.candidates[cell] == 0) grid.broken = true;
+    return true;
+}
+
+// Bit k of the result is set when the k-th cell of `unit` can hold `bit`.
+static uint16_t positionsOf(const LogicGrid& grid, int unit, uint16_t bit) {
+    uint16_t positions = 0;
+    for (int k = 0; k < GRID_SIZE; k++) {
+        if (grid.candidates[TABLES.unitCells[unit][k]] & bit) positions |= (uint16_t)(1 << k);
+    }
+    return positions;
+}
+
+static bool hiddenSingle(LogicGrid& grid) {
+    bool progress = false;
+    for (int unit = 0; unit < UNITS; unit++) {
+        uint16_t once = 0, twice = 0, placed = 0;
+        for (int cell : TABLES.unitCells[unit]) {
+            uint16_t mask = grid.candidates[cell];
+            twice |= once & mask;
+            once |= mask;
+            if (grid.cells[cell] != 0) placed |= (uint16_t)(1 << (grid.cells[cell] - 1));
+        }
+        if ((once | placed) != ALL_CANDIDATES) {
+            grid.broken = true;
+            return false;
+        }
+
+        uint16_t singles = once & ~twice;
+        while (singles) {
+            uint16_t bit = singles & -singles;
+            singles &= singles - 1;
+            for (int cell : TABLES.unitCells[unit]) {
+                if (grid.candidates[cell] & bit) {
+                    place(grid, cell, __builtin_ctz(bit) + 1);
+                    progress = true;
+                    break;
+                }
+            }
+        }
+        if (grid.broken) return false;
+    }
+    return progress;
+}
+
+static bool nakedSingle(LogicGrid& grid) {
+    bool progress = false;
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        uint16_t mask = grid.candidates[cell];
+        if (grid.cells[cell] != 0 || mask == 0 || (mask & (mask - 1))) continue;
+        place(grid, cell, __builtin_ctz(mask) + 1);
+        progress = true;
+        if (grid.broken) return false;
+    }
+    return progress;
+}
+
+// A digit confined to one line inside a box leaves the rest of that line.
+static bool pointing(LogicGrid& grid) {
+    bool progress = false;
+    for (int box = 0; box < GRID_SIZE; box++) {
+        int unit = 2 * GRID_SIZE + box;
+        for (int digit = 0; digit < GRID_SIZE; digit++) {
+            uint16_t bit = (uint16_t)(1 << digit);
+            uint16_t positions = positionsOf(grid, unit, bit);
+            if (positions == 0) continue;
+
+            int first = TABLES.unitCells[unit][__builtin_ctz(positions)];
+            bool sameRow = true, sameCol = true;
+            for (int k = 0; k < GRID_SIZE; k++) {
+                if (!(positions & (1 << k))) continue;
+                int cell = TABLES.unitCells[unit][k];
+                sameRow &= cell / GRID_SIZE == first / GRID_SIZE;
+                sameCol &= cell % GRID_SIZE == first % GRID_SIZE;
+            }
+            if (!sameRow && !sameCol) continue;
+
+            int line = sameRow ? TABLES.cellUnits[first][0] : TABLES.cellUnits[first][1];
+            for (int cell : TABLES.unitCells[line]) {
+                if (TABLES.cellUnits[cell][2] != unit) progress |= eliminate(grid, cell, bit);
+            }
+        }
+    }
+    return progress;
+}
+
+// A digit confined to one box inside a line leaves the rest of that box.
+static bool claiming(LogicGrid& grid) {
+    bool progress = false;
+    for (int line = 0; line < 2 * GRID_SIZE; line++) {
+        for (int digit = 0; digit < GRID_SIZE; digit++) {
+            uint16_t bit = (uint16_t)(1 << digit);
+            uint16_t positions = positionsOf(grid, line, bit);
+            if (positions == 0) continue;
+
+            int box = TABLES.cellUnits[TABLES.unitCells[line][__builtin_ctz(positions)]][2];
+            bool oneBox = true;
+            for (int k = 0; k < GRID_SIZE; k++) {
+                if ((positions & (1 << k)) && TABLES.cellUnits[TABLES.unitCells[line][k]][2] != box) oneBox = false;
+            }
+            if (!oneBox) continue;
+
+            for (int cell : TABLES.unitCells[box]) {
+                if (TABLES.cellUnits[cell][0] != line && TABLES.cellUnits[cell][1] != line) {
+                    progress |= eliminate(grid, cell, bit);
+                }
+            }
+        }
+    }
+    return progress;
+}
+
+// Calls visit(chosenMask) for every `size`-element subset of the bits in `pool`.
+template <typename Visit>
+static bool forEachSubset(uint16_t pool, int size, uint16_t chosen, int start, const Visit& visit) {
+    if (size == 0) return visit(chosen);
+    for (int i = start; i < GRID_SIZE; i++) {
+        if (!(pool & (1 << i))) continue;
+        if (forEachSubset(pool, size - 1, chosen | (uint16_t)(1 << i), i + 1, visit)) return true;
+    }
+    return false;
+}
+
+// `size` cells of a unit sharing exactly `size` candidates own those digits.
+static bool nakedSubset(LogicGrid& grid, int size) {
+    for (int unit = 0; unit < UNITS; unit++) {
+        uint16_t pool = 0;
+        for (int k = 0; k < GRID_SIZE; k++) {
+            uint16_t mask = grid.candidates[TABLES.unitCells[unit][k]];
+            int count = __builtin_popcount(mask);
+            if (count >= 2 && count <= size) pool |= (uint16_t)(1 << k);
+        }
+        if (__builtin_popcount(pool) < size) continue;
+
+        bool found = forEachSubset(pool, size, 0, 0, [&](uint16_t chosen) {
+            uint16_t digits = 0;
+            for (int k = 0; k < GRID_SIZE; k++) {
+                if (chosen & (1 << k)) digits |= grid.candidates[TABLES.unitCells[unit][k]];
+            }
+            if (__builtin_popcount(digits) != size) return false;
+
+            bool progress = false;
+            for (int k = 0; k < GRID_SIZE; k++) {
+                if (!(chosen & (1 << k))) progress |= eliminate(grid, TABLES.unitCells[unit][k], digits);
+            }
+            return progress;
+        });
+        if (found) return true;
+    }
+    return false;
+}
+
+// `size` digits that fit only into the same `size` cells clear those cells.
+static bool hiddenSubset(LogicGrid& grid, int size) {
+    for (int unit = 0; unit < UNITS; unit++) {
+        uint16_t positions[GRID_SIZE];
+        uint16_t pool = 0;
+        for (int digit = 0; digit < GRID_SIZE; digit++) {
+            positions[digit] = positionsOf(grid, unit, (uint16_t)(1 << digit));
+            int count = __builtin_popcount(positions[digit]);
+            if (count >= 2 && count <= size) pool |= (uint16_t)(1 << digit);
+        }
+        if (__builtin_popcount(pool) < size) continue;
+
+        bool found = forEachSubset(pool, size, 0, 0, [&](uint16_t digits) {
+            uint16_t cells = 0;
+            for (int digit = 0; digit < GRID_SIZE; digit++) {
+                if (digits & (1 << digit)) cells |= positions[digit];
+            }
+            if (__builtin_popcount(cells) != size) return false;
+
+            bool progress = false;
+            for (int k = 0; k < GRID_SIZE; k++) {
+                if (cells & (1 << k)) progress |= eliminate(grid, TABLES.unitCells[unit][k], ALL_CANDIDATES & ~digits);
+            }
+            return progress;
+        });
+        if (found) return true;
+    }
+    return false;
+}
+
+// X-Wing (size 2) and Swordfish (size 3), on rows and then on columns.
+static bool fish(LogicGrid& grid, int size) {
+    for (int digit = 0; digit < GRID_SIZE; digit++) {
+        uint16_t bit = (uint16_t)(1 << digit);
+        for (int base = 0; base < 2 * GRID_SIZE; base += GRID_SIZE) {
+            int cover = GRID_SIZE - base;
+            uint16_t positions[GRID_SIZE];
+            uint16_t pool = 0;
+            for (int line = 0; line < GRID_SIZE; line++) {
+                positions[line] = positionsOf(grid, base + line, bit);
+                int count = __builtin_popcount(positions[line]);
+                if (count >= 2 && count <= size) pool |= (uint16_t)(1 << line);
+            }
+            if (__builtin_popcount(pool) < size) continue;
+
+            bool found = forEachSubset(pool, size, 0, 0, [&](uint16_t lines) {
+                uint16_t crossing = 0;
+                for (int line = 0; line < GRID_SIZE; line++) {
+                    if (lines & (1 << line)) crossing |= positions[line];
+                }
+                if (__builtin_popcount(crossing) != size) return false;
+
+                bool progress = false;
+                for (int k = 0; k < GRID_SIZE; k++) {
+                    if (!(crossing & (1 << k))) continue;
+                    for (int line = 0; line < GRID_SIZE; line++) {
+                        if (lines & (1 << line)) continue;
+                        progress |= eliminate(grid, TABLES.unitCells[cover + k][line], bit);
+                    }
+                }
+                return progress;
+            });
+            if (found) return true;
+        }
+    }
+    return false;
+}
+
+// The shortest bivalue chain: a pivot {x,y} sees pincers {x,z} and {y,z}; one
+// of the pincers must be z, so a cell seeing both cannot be.
+static bool xyWing(LogicGrid& grid) {
+    for (int pivot = 0; pivot < BOARD_CELLS; pivot++) {
+        uint16_t pivotMask = grid.candidates[pivot];
+        if (__builtin_popcount(pivotMask) != 2) continue;
+
+        const uint8_t* peers = TABLES.peers[pivot];
+        for (int i = 0; i < 20; i++) {
+            int first = peers[i];
+            uint16_t firstMask = grid.candidates[first];
+            if (__builtin_popcount(firstMask) != 2 || __builtin_popcount(firstMask & pivotMask) != 1) continue;
+
+            for (int j = i + 1; j < 20; j++) {
+                int second = peers[j];
+                uint16_t secondMask = grid.candidates[second];
+                if (__builtin_popcount(secondMask) != 2 || __builtin_popcount(secondMask & pivotMask) != 1) continue;
+                if ((secondMask & pivotMask) == (firstMask & pivotMask)) continue;
+
+                uint16_t z = firstMask & secondMask & (uint16_t)~pivotMask;
+                if (z == 0) continue;
+
+                bool progress = false;
+                for (int cell : TABLES.peers[first]) {
+                    if (cell != pivot && cell != second && sees(cell, second)) progress |= eliminate(grid, cell, z);
+                }
+                if (progress) return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Single-digit chains: cells linked by conjugate pairs (the only two places
+// for the digit in some unit) alternate between true and false. A colour that
+// sees itself is false; a cell that sees both colours loses the digit.
+static bool simpleColoring(LogicGrid& grid) {
+    for (int digit = 0; digit < GRID_SIZE; digit++) {
+        uint16_t bit = (uint16_t)(1 << digit);
+        int8_t color[BOARD_CELLS];
+        memset(color, -1, sizeof(color));
+        uint8_t links[BOARD_CELLS][3];
+        uint8_t linkCount[BOARD_CELLS] = {};
+
+        for (int unit = 0; unit < UNITS; unit++) {
+            uint16_t positions = positionsOf(grid, unit, bit);
+            if (__builtin_popcount(positions) != 2) continue;
+            int a = TABLES.unitCells[unit][__builtin_ctz(positions)];
+            int b = TABLES.unitCells[unit][31 - __builtin_clz(positions)];
+            if (linkCount[a] < 3) links[a][linkCount[a]++] = (uint8_t)b;
+            if (linkCount[b] < 3) links[b][linkCount[b]++] = (uint8_t)a;
+        }
+
+        for (int start = 0; start < BOARD_CELLS; start++) {
+            if (linkCount[start] == 0 || color[start] != -1) continue;
+
+            uint8_t component[BOARD_CELLS];
+            int size = 0;
+            color[start] = 0;
+            component[size++] = (uint8_t)start;
+            for (int i = 0; i < size; i++) {
+                int cell = component[i];
+                for (int j = 0; j < linkCount[cell]; j++) {
+                    int next = links[cell][j];
+                    if (color[next] != -1) continue;
+                    color[next] = (int8_t)(1 - color[cell]);
+                    component[size++] = (uint8_t)next;
+                }
+            }
+            if (size < 3) continue;
+
+            for (int i = 0; i < size; i++) {
+                for (int j = i + 1; j < size; j++) {
+                    int a = component[i], b = component[j];
+                    if (color[a] != color[b] || !sees(a, b)) continue;
+
+                    bool progress = false;
+                    for (int k = 0; k < size; k++) {
+                        if (color[component[k]] == color[a]) progress |= eliminate(grid, component[k], bit);
+                    }
+                    if (progress) return true;
+                }
+            }
+
+            bool progress = false;
+            for (int cell = 0; cell < BOARD_CELLS; cell++) {
+                if (color[cell] != -1 || !(grid.candidates[cell] & bit)) continue;
+                bool seesColor[2] = {false, false};
+                for (int i = 0; i < size; i++) {
+                    if (sees(cell, component[i])) seesColor[color[component[i]]] = true;
+                }
+                if (seesColor[0] && seesColor[1]) progress |= eliminate(grid, cell, bit);
+            }
+            if (progress) return true;
+        }
+    }
+    return false;
+}
+
+static bool applyTechnique(LogicGrid& grid, Technique technique) {
+    switch (technique) {
+        case TECH_HIDDEN_SINGLE: return hiddenSingle(grid);
+        case TECH_NAKED_SINGLE: return nakedSingle(grid);
+        case TECH_POINTING: return pointing(grid);
+        case TECH_CLAIMING: return claiming(grid);
+        case TECH_NAKED_PAIR: return nakedSubset(grid, 2);
+        case TECH_X_WING: return fish(grid, 2);
+        case TECH_HIDDEN_PAIR: return hiddenSubset(grid, 2);
+        case TECH_NAKED_TRIPLE: return nakedSubset(grid, 3);
+        case TECH_SWORDFISH: return fish(grid, 3);
+        case TECH_HIDDEN_TRIPLE: return hiddenSubset(grid, 3);
+        case TECH_XY_WING: return xyWing(grid);
+        case TECH_SIMPLE_COLORING: return simpleColoring(grid);
+        default: return false;
+    }
+}
+
+bool gradePuzzleCells(const uint8_t* cells, GradeResult& result) {
+    memset(&result, 0, sizeof(GradeResult));
+
+    LogicGrid grid;
+    grid.empty = BOARD_CELLS;
+    grid.broken = false;
+    memset(grid.cells, 0, sizeof(grid.cells));
+    for (int cell = 0; cell < BOARD_CELLS; cell++) grid.candidates[cell] = ALL_CANDIDATES;
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        if (cells[cell] > GRID_SIZE) grid.broken = true;
+        else if (cells[cell] != 0) place(grid, cell, cells[cell]);
+    }
+
+    while (grid.empty > 0 && !grid.broken) {
+        bool progress = false;
+        for (int technique = 0; technique < TECH_COUNT && !progress; technique++) {
+            if (!applyTechnique(grid, (Technique)technique)) continue;
+            progress = true;
+            result.steps[technique]++;
+            if (TECHNIQUE_RATING[technique] > result.rating) result.rating = TECHNIQUE_RATING[technique];
+        }
+        if (!progress) break;
+    }
+
+    memcpy(result.cells, grid.cells, sizeof(result.cells));
+    result.solved = grid.empty == 0 && !grid.broken;
+    if (!result.solved) result.rating = UNSOLVED_RATING;
+    return result.solved;
+}
+
+bool gradePuzzle(const Board& puzzle, GradeResult& result) {
+    return gradePuzzleCells(puzzle.cells, result);
+}
+
+// Finds a single without placing it, hidden singles first like the grader.
+static bool nextSingle(const LogicGrid& grid, Hint& hint) {
+    for (int unit = 0; unit < UNITS; unit++) {
+        uint16_t once = 0, twice = 0;
+        for (int cell : TABLES.unitCells[unit]) {
+            twice |= once & grid.candidates[cell];
+            once |= grid.candidates[cell];
+        }
+        uint16_t singles = once & ~twice;
+        if (singles == 0) continue;
+
+        uint16_t bit = singles & -singles;
+        for (int cell : TABLES.unitCells[unit]) {
+            if (!(grid.candidates[cell] & bit)) continue;
+            hint = {cell, __builtin_ctz(bit) + 1, TECH_HIDDEN_SINGLE};
+            return true;
+        }
+    }
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        uint16_t mask = grid.candidates[cell];
+        if (grid.cells[cell] != 0 || mask == 0 || (mask & (mask - 1))) continue;
+        hint = {cell, __builtin_ctz(mask) + 1, TECH_NAKED_SINGLE};
+        return true;
+    }
+    return false;
+}
+
+bool findHint(const Board& board, Hint& hint) {
+    LogicGrid grid;
+    grid.empty = 0;
+    grid.broken = false;
+    memcpy(grid.cells, board.cells, sizeof(grid.cells));
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        grid.candidates[cell] = board.cells[cell] == 0 ? board.candidates[cell] : 0;
+        if (board.cells[cell] == 0) grid.empty++;
+    }
+
+    Technique hardest = TECH_HIDDEN_SINGLE;
+    while (grid.empty > 0 && !grid.broken) {
+        if (nextSingle(grid, hint)) {
+            if (hardest > hint.technique) hint.technique = hardest;
+            return true;
+        }
+
+        bool progress = false;
+        for (int technique = TECH_POINTING; technique < TECH_COUNT && !progress; technique++) {
+            progress = applyTechnique(grid, (Technique)technique);
+            if (progress && technique > hardest) hardest = (Technique)technique;
+        }
+        if (!progress) break;
+    }
+    return false;
+}
+
+const char* techniqueName(Technique technique) {
+    return technique >= 0 && technique < TECH_COUNT ? TECHNIQUE_NAME[technique] : "?";
+}
+
+int techniqueRating(Technique technique) {
+    return technique >= 0 && technique < TECH_COUNT ? TECHNIQUE_RATING[technique] : UNSOLVED_RATING;
+}
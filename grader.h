@@ -0,0 +1,55 @@
+#ifndef GRADER_H
+#define GRADER_H
+
+#include <cstdint>
+#include "board.h"
+
+// Ordered from easiest to hardest; the grader always applies the easiest
+// technique that makes progress.
+enum Technique {
+    TECH_HIDDEN_SINGLE,
+    TECH_NAKED_SINGLE,
+    TECH_POINTING,
+    TECH_CLAIMING,
+    TECH_NAKED_PAIR,
+    TECH_X_WING,
+    TECH_HIDDEN_PAIR,
+    TECH_NAKED_TRIPLE,
+    TECH_SWORDFISH,
+    TECH_HIDDEN_TRIPLE,
+    TECH_XY_WING,
+    TECH_SIMPLE_COLORING,
+    TECH_COUNT
+};
+
+// Ratings are in tenths, on roughly the Sudoku Explainer scale. A puzzle that
+// logic alone cannot finish gets UNSOLVED_RATING.
+const int UNSOLVED_RATING = 100;
+
+struct GradeResult {
+    bool solved;
+    int rating;
+    int steps[TECH_COUNT];
+    uint8_t cells[BOARD_CELLS];
+};
+
+// Solves like a person would and rates the puzzle by its hardest step.
+// result.cells holds the grid as far as logic got.
+bool gradePuzzleCells(const uint8_t* cells, GradeResult& result);
+bool gradePuzzle(const Board& puzzle, GradeResult& result);
+
+// The next cell logic can fill and the hardest technique needed to get there.
+struct Hint {
+    int cell;
+    int digit;
+    Technique technique;
+};
+
+// Starts from the board's current cells and candidates (kept up to date by
+// BoardState) and stops at the first placement, so it only does the work
+// for one step rather than re-solving the puzzle.
+bool findHint(const Board& board, Hint& hint);
+const char* techniqueName(Technique technique);
+int techniqueRating(Technique technique);
+
+#endif
@@ -0,0 +1,101 @@
+#include "input_log.h"
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+
+static void writeRecord(InputLog& log, uint8_t kind, uint32_t now, uint64_t data, uint8_t flags,
+                        const GameInput* input) {
+    if (log.file == nullptr) return;
+
+    InputRecord record;
+    memset(&record, 0, sizeof(record));
+    record.data = data;
+    record.timeMs = now - log.startMs;
+    if (input != nullptr) record.input = *input;
+    record.kind = kind;
+    record.flags = flags;
+    fwrite(&record, sizeof(record), 1, log.file);
+}
+
+bool openInputLog(InputLog& log, const char* path, const GameSession& session, const GameSnapshot* saved,
+                  const vector<MoveRecord>& moves, uint32_t now) {
+    log.file = fopen(path, "wb");
+    if (log.file == nullptr) {
+        cerr << "Khong mo duoc file " << path << "!" << endl;
+        return false;
+    }
+    log.startMs = now;
+
+    InputLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC));
+    header.version = INPUT_LOG_VERSION;
+    header.difficulty = (uint8_t)session.difficulty;
+    header.symmetry = (uint8_t)session.symmetry;
+    header.resumed = saved != nullptr;
+    header.moveCount = saved != nullptr ? (uint32_t)moves.size() : 0;
+    fwrite(&header, sizeof(header), 1, log.file);
+    if (saved != nullptr) {
+        fwrite(saved, sizeof(*saved), 1, log.file);
+        fwrite(moves.data(), sizeof(MoveRecord), moves.size(), log.file);
+    } else {
+        logPuzzle(log, session, now);
+    }
+    return true;
+}
+
+void logInput(InputLog& log, const GameInput& input, uint32_t now) {
+    writeRecord(log, RECORD_INPUT, now, 0, 0, &input);
+}
+
+void logPuzzle(InputLog& log, const GameSession& session, uint32_t now) {
+    writeRecord(log, RECORD_PUZZLE, now, session.puzzle.id, session.puzzle.fromBank, nullptr);
+}
+
+void logClock(InputLog& log, uint32_t now) {
+    writeRecord(log, RECORD_CLOCK, now, 0, 0, nullptr);
+}
+
+void closeInputLog(InputLog& log, const GameSession& session, uint32_t now) {
+    if (log.file == nullptr) return;
+
+    writeRecord(log, RECORD_END, now, hashGameSession(session), 0, nullptr);
+    if (fclose(log.file) != 0) cerr << "Khong ghi het duoc ban ghi thao tac!" << endl;
+    log.file = nullptr;
+}
+
+bool loadInputScript(const char* path, InputScript& script) {
+    script.moves.clear();
+    script.records.clear();
+    FILE* in = fopen(path, "rb");
+    if (in == nullptr) {
+        cerr << "Khong mo duoc file " << path << "!" << endl;
+        return false;
+    }
+
+    InputLogHeader& header = script.header;
+    bool ok = fread(&header, sizeof(header), 1, in) == 1
+           && memcmp(header.magic, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC)) == 0
+           && header.version == INPUT_LOG_VERSION && header.difficulty < DIFFICULTY_COUNT;
+    if (ok && header.resumed) {
+        script.moves.resize(header.moveCount);
+        ok = fread(&script.saved, sizeof(script.saved), 1, in) == 1
+          && fread(script.moves.data(), sizeof(MoveRecord), script.moves.size(), in) == script.moves.size();
+    }
+    if (!ok) {
+        cerr << "File " << path << " khong phai ban ghi thao tac hop le!" << endl;
+        fclose(in);
+        return false;
+    }
+
+    InputRecord record;
+    while (fread(&record, sizeof(record), 1, in) == 1) {
+        if (record.kind > RECORD_END) break;
+        script.records.push_back(record);
+        if (record.kind == RECORD_END) break;
+    }
+    fclose(in);
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "game_logic.h"
+#include "save_game.h"
+
+// An input recording: InputLogHeader, then for a resumed game the raw
+// GameSnapshot and its journal tail, then InputRecords in order. Times are
+// milliseconds from the start of the recording. The snapshot is written as
+// the struct is laid out in memory, so a recording only replays on a build
+// of the same platform.
+const char INPUT_LOG_MAGIC[8] = {'S', 'D', 'K', 'I', 'N', 'P', 'U', 'T'};
+const uint32_t INPUT_LOG_VERSION = 1;
+
+enum InputRecordKind {
+    RECORD_INPUT,
+    // A new puzzle; data is its id, flags is 1 if it came from the bank.
+    RECORD_PUZZLE,
+    // A clock update that ended the game. Updates that change nothing are
+    // not recorded, which keeps a replay exact without logging every frame.
+    RECORD_CLOCK,
+    // The last record; data is hashGameSession at the end.
+    RECORD_END
+};
+
+struct InputLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint8_t difficulty;
+    uint8_t symmetry;
+    uint8_t resumed;
+    uint8_t reserved;
+    uint32_t moveCount;
+};
+
+struct InputRecord {
+    uint64_t data;
+    uint32_t timeMs;
+    GameInput input;
+    uint8_t kind;
+    uint8_t flags;
+    uint8_t reserved[4];
+};
+
+struct InputLog {
+    FILE* file = nullptr;
+    uint32_t startMs = 0;
+};
+
+// Call it right after the first game was started or restored, with the same
+// `now`. `saved` is null for a new game.
+bool openInputLog(InputLog& log, const char* path, const GameSession& session, const GameSnapshot* saved,
+                  const std::vector<MoveRecord>& moves, uint32_t now);
+void logInput(InputLog& log, const GameInput& input, uint32_t now);
+void logPuzzle(InputLog& log, const GameSession& session, uint32_t now);
+void logClock(InputLog& log, uint32_t now);
+void closeInputLog(InputLog& log, const GameSession& session, uint32_t now);
+
+struct InputScript {
+    InputLogHeader header;
+    GameSnapshot saved;
+    std::vector<MoveRecord> moves;
+    std::vector<InputRecord> records;
+};
+
+// A recording cut short (no RECORD_END) still loads; the replay then has
+// nothing to compare against at the end.
+bool loadInputScript(const char* path, InputScript& script);
+
+#endif
@@ -7,37 +7,31 @@
 #include <algorithm>
 #include <random>
 #include <cstdlib>
-#include <ctime>
-#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <cinttypes>
+#include "asset_loader.h"
+#include "board_render.h"
+#include "frame_scheduler.h"
+#include "game_logic.h"
+#include "input_log.h"
+#include "perf_trace.h"
+#include "puzzle_bank.h"
+#include "puzzle_pool.h"
+#include "save_game.h"
+#include "text_cache.h"
 
 using namespace std;
 
 
-const int GRID_SIZE = 9;
-const int GAME_AREA_SIZE = 630;
-const int UI_AREA_HEIGHT = 30;
-const int SCREEN_WIDTH = GAME_AREA_SIZE;
-const int SCREEN_HEIGHT = GAME_AREA_SIZE + UI_AREA_HEIGHT;
-const int CELL_SIZE = GAME_AREA_SIZE / GRID_SIZE;
-const int GAME_AREA_Y_OFFSET = UI_AREA_HEIGHT;
+const char* SAVE_PATH = "sudoku.sav";
+const char* JOURNAL_PATH = "sudoku.journal";
 
-const int LINE_WIDTH = 2;
-const int THICK_LINE_WIDTH = 4;
-const int GAME_DURATION = 1800;
 
-
-const SDL_Color WHITE = {255, 255, 255, 255};
-const SDL_Color BLACK = {0, 0, 0, 255};
-const SDL_Color GRAY = {220, 220, 220, 255};
-const SDL_Color HIGHLIGHTED = {180, 210, 255, 180};
-const SDL_Color NUMBER_COLOR = {0, 0, 150, 255};
-const SDL_Color ORIGINAL_NUMBER_COLOR = {0, 0, 0, 255};
 const SDL_Color MENU_TEXT_COLOR = {0, 0, 255, 255};
-const SDL_Color TIMER_COLOR = {255, 0, 0, 255};
-const SDL_Color TRIES_COLOR = {0, 100, 0, 255};
 
-int selectedRow = -1;
-int selectedCol = -1;
+bool perfOverlay = false;
+const char* gTracePath = nullptr;
 
 
 TTF_Font* gFont = nullptr;
@@ -52,202 +46,99 @@ Mix_Music* gBackgroundMusic = nullptr;
 
 SDL_Texture* backgroundTexture = nullptr;
 
-
-enum GameState {
-    MENU,
-    RUNNING,
-    PAUSED,
-    GAME_OVER,
-    WIN
-};
-GameState gameState = MENU;
-
-
-enum PauseMenuSelection {
-    RESUME,
-    RESTART,
-    QUIT
+PuzzlePool gPuzzlePool;
+PuzzleBank gPuzzleBank;
+SaveWriter gSaveWriter;
+GameSession gSession;
+InputLog gInputLog;
+
+// Startup assets still being decoded by gAssets; each is cleared once collected.
+struct PendingAssets {
+    Asset* font = nullptr;
+    Asset* fontSmall = nullptr;
+    Asset* atlas = nullptr;
+    Asset* soundCorrect = nullptr;
+    Asset* soundWrong = nullptr;
+    Asset* music = nullptr;
+    Asset* background = nullptr;
 };
-
-PauseMenuSelection currentSelection = RESUME;
+AssetBundle gBundle;
+AssetLoader gAssets;
+PendingAssets gPending;
+const int MAX_LOADER_THREADS = 4;
+const char* const ASSET_BUNDLE_PATH = "assets.pak";
+FrameScheduler gFrames;
+const int DEFAULT_FPS_CAP = 60;
 
 
-bool isSafe(const vector<vector<int>>& board, int row, int col, int num);
-bool solveSudoku(vector<vector<int>>& board);
-void buildSudoku(vector<vector<int>>& board);
-bool showMenu(SDL_Renderer* renderer);
-void drawLine(SDL_Renderer* renderer, int x1, int y1, int x2, int y2, int width);
-void drawRectangle(SDL_Renderer* renderer, int x, int y, int w, int h, SDL_Color color);
-void drawNumber(SDL_Renderer* renderer, int row, int col, int number, bool isOriginal);
+bool showMenu(SDL_Renderer* renderer, bool canResume, bool& resume);
 void renderPauseScreen(SDL_Renderer* renderer);
 void renderGameOverScreen(SDL_Renderer* renderer, const string& message);
 void renderWinScreen(SDL_Renderer* renderer);
-void drawTimer(SDL_Renderer* renderer, int timeLeft);
-void drawTries(SDL_Renderer* renderer, int triesLeft);
-SDL_Texture* loadTexture(const string& path, SDL_Renderer* renderer);
-Mix_Chunk* loadSound(const string& path);
-Mix_Music* loadMusic(const string& path); // Added prototype
+SDL_Texture* loadTexture(Asset* image, SDL_Renderer* renderer);
+void requestStartupAssets();
+bool collectAssets(SDL_Renderer* renderer);
 void closeSDL(SDL_Window* window, SDL_Renderer* renderer);
+bool eventChangesFrame(const SDL_Event& event);
+bool translateEvent(const SDL_Event& event, GameInput& input);
+void playEffects(unsigned effects);
 
 
 
-bool isSafe(const vector<vector<int>>& board, int row, int col, int num) {
-
-    for (int x = 0; x < GRID_SIZE; x++) {
-        if (board[row][x] == num || board[x][col] == num)
-            return false;
-    }
-
-
-    int startRow = row - row % 3;
-    int startCol = col - col % 3;
-    for (int i = startRow; i < startRow + 3; i++) {
-        for (int j = startCol; j < startCol + 3; j++) {
-
-            if (board[i][j] == num)
-                return false;
-        }
-    }
-
-    return true;
-}
-
-bool solveSudoku(vector<vector<int>>& board) {
-    for (int row = 0; row < GRID_SIZE; row++) {
-        for (int col = 0; col < GRID_SIZE; col++) {
-            if (board[row][col] == 0) {
-                 vector<int> numbers = {1, 2, 3, 4, 5, 6, 7, 8, 9};
-                 shuffle(numbers.begin(), numbers.end(), mt19937{random_device{}()});
-                 for (int number : numbers) {
-                    if (isSafe(board, row, col, number)) {
-                        board[row][col] = number;
-                        if (solveSudoku(board)) {
-                            return true;
-                        } else {
-                            board[row][col] = 0;
-                        }
-                    }
-                }
-                return false;
-            }
-        }
-    }
-    return true;
-}
-
-void buildSudoku(vector<vector<int>>& board) {
-    board.assign(GRID_SIZE, vector<int>(GRID_SIZE, 0));
-
-
-    solveSudoku(board);
-}
-
-bool showMenu(SDL_Renderer* renderer) {
+// With a saved game ENTER resumes it and N starts a new one.
+bool showMenu(SDL_Renderer* renderer, bool canResume, bool& resume) {
     SDL_Event event;
     bool inMenu = true;
 
     while (inMenu) {
-        while (SDL_PollEvent(&event)) {
+        bool haveEvent = waitFrameEvent(gFrames, event);
+        for (; haveEvent; haveEvent = SDL_PollEvent(&event) != 0) {
+            if (eventChangesFrame(event)) requestRedraw(gFrames);
             if (event.type == SDL_QUIT) {
                 return false;
+            } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3) {
+                perfOverlay = !perfOverlay;
             } else if (event.type == SDL_KEYDOWN) {
-                if (event.key.keysym.sym == SDLK_RETURN) {
+                if (event.key.keysym.sym == SDLK_RETURN && gFont != nullptr) {
+                    resume = canResume;
+                    return true;
+                } else if (event.key.keysym.sym == SDLK_n && canResume && gFont != nullptr) {
+                    resume = false;
                     return true;
                 } else if (event.key.keysym.sym == SDLK_ESCAPE) {
                     return false;
                 }
             }
         }
+        if (!collectAssets(renderer)) return false;
+        if (!frameDue(gFrames)) continue;
 
+        beginFrame(gFrames);
         SDL_SetRenderDrawColor(renderer, WHITE.r, WHITE.g, WHITE.b, WHITE.a);
         SDL_RenderClear(renderer);
 
 
-        SDL_Surface* textSurface = TTF_RenderText_Solid(gFont, "SUDOKU", MENU_TEXT_COLOR);
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        SDL_Rect textRect = {(SCREEN_WIDTH - textSurface->w) / 2, SCREEN_HEIGHT / 4, textSurface->w, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-
-        textSurface = TTF_RenderText_Solid(gFontSmall, "Nhan ENTER de bat dau", BLACK);
-        textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        textRect = {(SCREEN_WIDTH - textSurface->w) / 2, SCREEN_HEIGHT / 2, textSurface->w, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-
-         textSurface = TTF_RenderText_Solid(gFontSmall, "Nhan ESC de thoat", BLACK);
-        textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        textRect = {(SCREEN_WIDTH - textSurface->w) / 2, SCREEN_HEIGHT / 2 + 40, textSurface->w, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-
+        TRACE_SCOPE("drawMenu");
+        drawCachedTextCentered(renderer, gFont, "SUDOKU", SCREEN_WIDTH, SCREEN_HEIGHT / 4, MENU_TEXT_COLOR);
+        if (canResume) {
+            drawCachedTextCentered(renderer, gFontSmall, "Nhan ENTER de choi tiep", SCREEN_WIDTH, SCREEN_HEIGHT / 2, BLACK);
+            drawCachedTextCentered(renderer, gFontSmall, "Nhan N de choi van moi", SCREEN_WIDTH, SCREEN_HEIGHT / 2 + 40,
+                                   BLACK);
+            drawCachedTextCentered(renderer, gFontSmall, "Nhan ESC de thoat", SCREEN_WIDTH, SCREEN_HEIGHT / 2 + 80, BLACK);
+        } else {
+            drawCachedTextCentered(renderer, gFontSmall, "Nhan ENTER de bat dau", SCREEN_WIDTH, SCREEN_HEIGHT / 2, BLACK);
+            drawCachedTextCentered(renderer, gFontSmall, "Nhan ESC de thoat", SCREEN_WIDTH, SCREEN_HEIGHT / 2 + 40, BLACK);
+        }
+        if (perfOverlay) drawPerfOverlay(renderer, summarizeFrames(gFrames));
+        endFrame(gFrames);
 
-        SDL_RenderPresent(renderer);
+        presentFrame(gFrames, renderer);
     }
     return false;
 }
 
-void drawLine(SDL_Renderer* renderer, int x1, int y1, int x2, int y2, int width) {
-    SDL_SetRenderDrawColor(renderer, BLACK.r, BLACK.g, BLACK.b, BLACK.a);
-
-
-    int dx = (x1 == x2) ? 1 : 0;
-    int dy = (y1 == y2) ? 1 : 0;
-
-    for (int i = -width / 2; i < (width + 1) / 2; ++i) {
-        SDL_RenderDrawLine(renderer, x1 + i * dx, y1 + i * dy, x2 + i * dx, y2 + i * dy);
-    }
-}
-
-void drawRectangle(SDL_Renderer* renderer, int x, int y, int w, int h, SDL_Color color) {
-    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-    SDL_Rect rect = {x, y, w, h};
-    SDL_RenderFillRect(renderer, &rect);
-}
-
-void drawNumber(SDL_Renderer* renderer, int row, int col, int number, bool isOriginal) {
-    if (number == 0) return;
-
-    string text = to_string(number);
-
-    SDL_Color textColor = isOriginal ? ORIGINAL_NUMBER_COLOR : NUMBER_COLOR;
-
-    if (gFont == nullptr) {
-        cerr << "Font chua duoc tai!" << endl;
-        return;
-    }
-
-    SDL_Surface* textSurface = TTF_RenderText_Solid(gFont, text.c_str(), textColor);
-    if (textSurface == nullptr) {
-        cerr << "Khong the render text surface! SDL_ttf Error: " << TTF_GetError() << endl;
-        return;
-    }
-
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    if (textTexture == nullptr) {
-        cerr << "Khong thể tao texture tu text! SDL Error: " << SDL_GetError() << endl;
-        SDL_FreeSurface(textSurface);
-        return;
-    }
-
-    int textWidth = textSurface->w;
-    int textHeight = textSurface->h;
-
-    int x = col * CELL_SIZE + (CELL_SIZE - textWidth) / 2;
-    int y = row * CELL_SIZE + (CELL_SIZE - textHeight) / 2 + GAME_AREA_Y_OFFSET;
-
-    SDL_Rect renderQuad = {x, y, textWidth, textHeight};
-    SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-
-    SDL_FreeSurface(textSurface);
-    SDL_DestroyTexture(textTexture);
-}
-
 void renderPauseScreen(SDL_Renderer* renderer) {
-
+    TRACE_SCOPE("renderPauseScreen");
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 150);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     SDL_Rect overlayRect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
@@ -255,219 +146,200 @@ void renderPauseScreen(SDL_Renderer* renderer) {
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
 
 
-    SDL_Color textColor;
-    SDL_Surface* textSurface;
-    SDL_Texture* textTexture;
-    SDL_Rect textRect;
-    int startY = SCREEN_HEIGHT / 3;
-    int spacing = 60;
-
+    int startY = PAUSE_MENU_Y;
+    int spacing = PAUSE_MENU_SPACING;
+    PauseMenuSelection selection = gSession.pauseSelection;
 
-    textColor = (currentSelection == RESUME) ? HIGHLIGHTED : WHITE;
-    textSurface = TTF_RenderText_Solid(gFont, "Tiep tuc (P)", textColor);
-    textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    textRect = {(SCREEN_WIDTH - textSurface->w) / 2, startY, textSurface->w, textSurface->h};
-    SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-    SDL_FreeSurface(textSurface);
-    SDL_DestroyTexture(textTexture);
-
-
-    textColor = (currentSelection == RESTART) ? HIGHLIGHTED : WHITE;
-    textSurface = TTF_RenderText_Solid(gFont, "Choi lai (R)", textColor);
-    textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    textRect = {(SCREEN_WIDTH - textSurface->w) / 2, startY + spacing, textSurface->w, textSurface->h};
-    SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-    SDL_FreeSurface(textSurface);
-    SDL_DestroyTexture(textTexture);
-
-
-    textColor = (currentSelection == QUIT) ? HIGHLIGHTED : WHITE;
-    textSurface = TTF_RenderText_Solid(gFont, "Thoat (Q)", textColor);
-    textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    textRect = {(SCREEN_WIDTH - textSurface->w) / 2, startY + 2 * spacing, textSurface->w, textSurface->h};
-    SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-    SDL_FreeSurface(textSurface);
-    SDL_DestroyTexture(textTexture);
+    drawCachedTextCentered(renderer, gFont, "Tiep tuc (P)", SCREEN_WIDTH, startY,
+                           (selection == RESUME) ? HIGHLIGHTED : WHITE);
+    drawCachedTextCentered(renderer, gFont, "Choi lai (R)", SCREEN_WIDTH, startY + spacing,
+                           (selection == RESTART) ? HIGHLIGHTED : WHITE);
+    drawCachedTextCentered(renderer, gFont, "Thoat (Q)", SCREEN_WIDTH, startY + 2 * spacing,
+                           (selection == QUIT) ? HIGHLIGHTED : WHITE);
 }
 
 void renderGameOverScreen(SDL_Renderer* renderer, const string& message) {
-
+    TRACE_SCOPE("renderGameOverScreen");
     SDL_SetRenderDrawColor(renderer, 150, 0, 0, 180);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     SDL_Rect overlayRect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
     SDL_RenderFillRect(renderer, &overlayRect);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
 
-    SDL_Color textColor = WHITE;
-    SDL_Surface* textSurfaceGameOver = TTF_RenderText_Solid(gFont, message.c_str(), textColor);
-    SDL_Texture* textTextureGameOver = SDL_CreateTextureFromSurface(renderer, textSurfaceGameOver);
-
-    SDL_Surface* textSurfaceOptions = TTF_RenderText_Solid(gFontSmall, "Nhan 'R' de Choi Lai hoac 'Q' de Thoat", textColor);
-    SDL_Texture* textTextureOptions = SDL_CreateTextureFromSurface(renderer, textSurfaceOptions);
-
-    SDL_Rect textRectGameOver;
-    textRectGameOver.w = textSurfaceGameOver->w;
-    textRectGameOver.h = textSurfaceGameOver->h;
-    textRectGameOver.x = (SCREEN_WIDTH - textRectGameOver.w) / 2;
-    textRectGameOver.y = SCREEN_HEIGHT / 3;
-
-    SDL_Rect textRectOptions;
-    textRectOptions.w = textSurfaceOptions->w;
-    textRectOptions.h = textSurfaceOptions->h;
-    textRectOptions.x = (SCREEN_WIDTH - textRectOptions.w) / 2;
-    textRectOptions.y = SCREEN_HEIGHT * 2 / 3;
-
-
-    SDL_RenderCopy(renderer, textTextureGameOver, NULL, &textRectGameOver);
-    SDL_RenderCopy(renderer, textTextureOptions, NULL, &textRectOptions);
-
-    SDL_FreeSurface(textSurfaceGameOver);
-    SDL_DestroyTexture(textTextureGameOver);
-    SDL_FreeSurface(textSurfaceOptions);
-    SDL_DestroyTexture(textTextureOptions);
+    drawCachedTextCentered(renderer, gFont, message, SCREEN_WIDTH, SCREEN_HEIGHT / 3, WHITE);
+    drawCachedTextCentered(renderer, gFontSmall, "Nhan 'R' de Choi Lai hoac 'Q' de Thoat", SCREEN_WIDTH,
+                           SCREEN_HEIGHT * 2 / 3, WHITE);
 }
 
 void renderWinScreen(SDL_Renderer* renderer) {
-
+    TRACE_SCOPE("renderWinScreen");
     SDL_SetRenderDrawColor(renderer, 0, 150, 0, 180);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     SDL_Rect overlayRect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
     SDL_RenderFillRect(renderer, &overlayRect);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
 
-    SDL_Color textColor = WHITE;
-    SDL_Surface* textSurfaceWin = TTF_RenderText_Solid(gFont, "CHIEN THANG!", textColor);
-    SDL_Texture* textTextureWin = SDL_CreateTextureFromSurface(renderer, textSurfaceWin);
-
-    SDL_Surface* textSurfaceOptions = TTF_RenderText_Solid(gFontSmall, "Nhan 'R' de Choi Lai hoac 'Q' de Thoat", textColor);
-    SDL_Texture* textTextureOptions = SDL_CreateTextureFromSurface(renderer, textSurfaceOptions);
-
-    SDL_Rect textRectWin;
-    textRectWin.w = textSurfaceWin->w;
-    textRectWin.h = textSurfaceWin->h;
-    textRectWin.x = (SCREEN_WIDTH - textRectWin.w) / 2;
-    textRectWin.y = SCREEN_HEIGHT / 3;
-
-    SDL_Rect textRectOptions;
-    textRectOptions.w = textSurfaceOptions->w;
-    textRectOptions.h = textSurfaceOptions->h;
-    textRectOptions.x = (SCREEN_WIDTH - textRectOptions.w) / 2;
-    textRectOptions.y = SCREEN_HEIGHT * 2 / 3;
-
-
-    SDL_RenderCopy(renderer, textTextureWin, NULL, &textRectWin);
-    SDL_RenderCopy(renderer, textTextureOptions, NULL, &textRectOptions);
-
-    SDL_FreeSurface(textSurfaceWin);
-    SDL_DestroyTexture(textTextureWin);
-    SDL_FreeSurface(textSurfaceOptions);
-    SDL_DestroyTexture(textTextureOptions);
+    drawCachedTextCentered(renderer, gFont, "CHIEN THANG!", SCREEN_WIDTH, SCREEN_HEIGHT / 3, WHITE);
+    drawCachedTextCentered(renderer, gFontSmall, "Nhan 'R' de Choi Lai hoac 'Q' de Thoat", SCREEN_WIDTH,
+                           SCREEN_HEIGHT * 2 / 3, WHITE);
 }
 
-void drawTimer(SDL_Renderer* renderer, int timeLeft) {
-    int minutes = timeLeft / 60;
-    int seconds = timeLeft % 60;
-
-    stringstream timeString;
-
-    timeString << "Time: " << (minutes < 10 ? "0" : "") << minutes << ":" << (seconds < 10 ? "0" : "") << seconds;
+SDL_Texture* loadTexture(Asset* image, SDL_Renderer* renderer) {
+    if (image->surface == nullptr) return nullptr;
 
-    if (gFontSmall == nullptr) return;
-
-    SDL_Surface* textSurface = TTF_RenderText_Solid(gFontSmall, timeString.str().c_str(), TIMER_COLOR);
-    if (!textSurface) return;
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    if (!textTexture) {
-        SDL_FreeSurface(textSurface);
-        return;
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, image->surface);
+    countTextureAllocation();
+    if (texture == nullptr) {
+        cerr << "Khong the tao texture tu " << image->name << "! SDL Error: " << SDL_GetError() << endl;
     }
 
-    SDL_Rect textRect;
-    textRect.w = textSurface->w;
-    textRect.h = textSurface->h;
-    textRect.x = 15;
-    textRect.y = (UI_AREA_HEIGHT - textRect.h) / 2;
-
-    SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-
-    SDL_FreeSurface(textSurface);
-    SDL_DestroyTexture(textTexture);
+    SDL_FreeSurface(image->surface);
+    image->surface = nullptr;
+    return texture;
 }
 
-void drawTries(SDL_Renderer* renderer, int triesLeft) {
-    stringstream triesString;
-    triesString << "Loi sai con lai: " << triesLeft;
-
-    if (gFontSmall == nullptr) return;
-
-    SDL_Surface* textSurface = TTF_RenderText_Solid(gFontSmall, triesString.str().c_str(), TRIES_COLOR);
-     if (!textSurface) return;
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-     if (!textTexture) {
-        SDL_FreeSurface(textSurface);
-        return;
-    }
-
-    SDL_Rect textRect;
-    textRect.w = textSurface->w;
-    textRect.h = textSurface->h;
-    textRect.x = SCREEN_WIDTH - textRect.w - 15;
-    textRect.y = (UI_AREA_HEIGHT - textRect.h) / 2;
-
-    SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
+void requestStartupAssets() {
+    gPending.font = requestFont(gAssets, "Arialbd.ttf", 36);
+    gPending.fontSmall = requestFont(gAssets, "Arial.ttf", 18);
+    Asset* font = gPending.font;
+    Asset* fontSmall = gPending.fontSmall;
+    gPending.atlas = requestDerived(gAssets, {font, fontSmall}, [font, fontSmall]() {
+        return buildGlyphAtlas(font->font, fontSmall->font);
+    });
+
+    gPending.soundCorrect = requestSound(gAssets, "moving.mp3");
+    gPending.soundWrong = requestSound(gAssets, "moving.mp3");
+    gPending.music = requestMusic(gAssets, "background.mp3");
+    gPending.background = requestImage(gAssets, "bikiniBottom.jpg");
+}
 
-    SDL_FreeSurface(textSurface);
-    SDL_DestroyTexture(textTexture);
+static Asset* takeReady(Asset*& pending) {
+    if (pending == nullptr || !pending->ready.load(memory_order_acquire)) return nullptr;
+    Asset* asset = pending;
+    pending = nullptr;
+    return asset;
 }
 
-SDL_Texture* loadTexture(const string& path, SDL_Renderer* renderer) {
-    SDL_Surface* loadedSurface = IMG_Load(path.c_str());
-    if (loadedSurface == nullptr) {
-        cerr << "Khong the tai hinh anh " << path << "! SDL_image Error: " << IMG_GetError() << endl;
-        return nullptr;
+// Picks up whatever the loader has finished. Fonts are published only together
+// with the atlas, so the render thread never uses SDL_ttf while a worker does.
+// Returns false when the fonts failed, since no screen can be drawn without them.
+bool collectAssets(SDL_Renderer* renderer) {
+    if (takeReady(gPending.atlas) != nullptr) {
+        if (!uploadGlyphAtlas(renderer)) return false;
+        gFont = gPending.font->font;
+        gFontSmall = gPending.fontSmall->font;
+        gSession.menuItemHeight = TTF_FontHeight(gFont);
+        requestRedraw(gFrames);
     }
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, loadedSurface);
-    if (texture == nullptr) {
-        cerr << "Khong the tao texture tu " << path << "! SDL Error: " << SDL_GetError() << endl;
+    if (Asset* image = takeReady(gPending.background)) {
+        backgroundTexture = loadTexture(image, renderer);
+        setBoardBackground(backgroundTexture);
+        requestRedraw(gFrames);
     }
-
-    SDL_FreeSurface(loadedSurface);
-    return texture;
+    if (Asset* sound = takeReady(gPending.soundCorrect)) gSoundCorrect = sound->chunk;
+    if (Asset* sound = takeReady(gPending.soundWrong)) gSoundWrong = sound->chunk;
+    if (Asset* music = takeReady(gPending.music)) {
+        gBackgroundMusic = music->music;
+        if (gBackgroundMusic != nullptr && gSession.gameState == RUNNING && Mix_PlayMusic(gBackgroundMusic, -1) == -1) {
+            cerr << "Mix_PlayMusic failed: " << Mix_GetError() << endl;
+        }
+    }
+    return true;
 }
 
-Mix_Chunk* loadSound(const string& path) {
-    Mix_Chunk* sound = Mix_LoadWAV(path.c_str());
-    if (sound == nullptr) {
-        cerr << "Khong tai duoc am thanh! SDL_mixer Error: " << Mix_GetError() << endl;
+// Mouse motion and key releases leave the screen as it was; only these can change it.
+bool eventChangesFrame(const SDL_Event& event) {
+    switch (event.type) {
+        case SDL_KEYDOWN:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_WINDOWEVENT:
+        case SDL_RENDER_TARGETS_RESET:
+        case SDL_RENDER_DEVICE_RESET:
+            return true;
+        default:
+            return false;
     }
-    return sound;
 }
 
+// Turns an event into the game's own input; false for events the game
+// logic does not look at.
+bool translateEvent(const SDL_Event& event, GameInput& input) {
+    input = {INPUT_CLICK, 0, 0, 0};
+    if (event.type == SDL_MOUSEBUTTONDOWN) {
+        input.value = event.button.button == SDL_BUTTON_LEFT;
+        input.x = (int16_t)event.button.x;
+        input.y = (int16_t)event.button.y;
+        return true;
+    }
+    if (event.type != SDL_KEYDOWN) return false;
+
+    SDL_Keycode key = event.key.keysym.sym;
+    Uint16 mod = event.key.keysym.mod;
+    if (key >= SDLK_1 && key <= SDLK_9) input.value = (uint8_t)(key - SDLK_0);
+    else if (key >= SDLK_KP_1 && key <= SDLK_KP_9) input.value = (uint8_t)(key - SDLK_KP_1 + 1);
+    if (input.value != 0) {
+        // Shift+digit toggles a pencil mark.
+        input.type = (mod & KMOD_SHIFT) ? INPUT_PENCIL : INPUT_DIGIT;
+        return true;
+    }
 
-Mix_Music* loadMusic(const string& path) {
-    Mix_Music* music = Mix_LoadMUS(path.c_str());
-    if (music == nullptr) {
-        cerr << "Khong tai duoc nhac nen! SDL_mixer Error: " << Mix_GetError() << endl;
+    switch (key) {
+        case SDLK_UP: input.type = INPUT_UP; break;
+        case SDLK_DOWN: input.type = INPUT_DOWN; break;
+        case SDLK_LEFT: input.type = INPUT_LEFT; break;
+        case SDLK_RIGHT: input.type = INPUT_RIGHT; break;
+        case SDLK_BACKSPACE:
+        case SDLK_DELETE:
+        case SDLK_0:
+        case SDLK_KP_0:
+            input.type = INPUT_ERASE;
+            break;
+        case SDLK_p: input.type = INPUT_PAUSE; break;
+        case SDLK_ESCAPE: input.type = INPUT_BACK; break;
+        case SDLK_RETURN: case SDLK_KP_ENTER: input.type = INPUT_CONFIRM; break;
+        case SDLK_r: input.type = INPUT_RESTART; break;
+        case SDLK_q: input.type = INPUT_QUIT; break;
+        case SDLK_h: input.type = INPUT_HINT; break;
+        case SDLK_z:
+        case SDLK_y:
+            // Ctrl+Z undoes, Ctrl+Y or Ctrl+Shift+Z redoes.
+            if (!(mod & KMOD_CTRL)) return false;
+            input.type = (key == SDLK_y || (mod & KMOD_SHIFT)) ? INPUT_REDO : INPUT_UNDO;
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
 
+void playEffects(unsigned effects) {
+    if (effects & EFFECT_SOUND_CORRECT) Mix_PlayChannel(-1, gSoundCorrect, 0);
+    if (effects & EFFECT_SOUND_WRONG) Mix_PlayChannel(-1, gSoundWrong, 0);
+    if ((effects & EFFECT_MUSIC_START) && gBackgroundMusic != nullptr && Mix_PlayMusic(gBackgroundMusic, -1) == -1) {
+        cerr << "Mix_PlayMusic failed: " << Mix_GetError() << endl;
     }
-    return music;
+    if (effects & EFFECT_MUSIC_PAUSE) Mix_PauseMusic();
+    if (effects & EFFECT_MUSIC_RESUME) Mix_ResumeMusic();
+    if (effects & EFFECT_MUSIC_STOP) Mix_HaltMusic();
 }
 
 void closeSDL(SDL_Window* window, SDL_Renderer* renderer) {
 
+    stopPuzzlePool(gPuzzlePool);
+    stopSaveWriter(gSaveWriter);
+    closePuzzleBank(gPuzzleBank);
+    if (gTracePath != nullptr) exportChromeTrace(gTracePath);
+    freeBoardLayers();
+    freeTextCache();
+    setBoardBackground(nullptr);
     SDL_DestroyTexture(backgroundTexture);
-    TTF_CloseFont(gFont);
+    backgroundTexture = nullptr;
+    freeAssets(gAssets);
+    closeAssetBundle(gBundle);
     gFont = nullptr;
-    TTF_CloseFont(gFontSmall);
     gFontSmall = nullptr;
-    Mix_FreeChunk(gSoundCorrect);
     gSoundCorrect = nullptr;
-    Mix_FreeChunk(gSoundWrong);
     gSoundWrong = nullptr;
-
-
-    Mix_FreeMusic(gBackgroundMusic);
     gBackgroundMusic = nullptr;
 
     SDL_DestroyRenderer(renderer);
@@ -483,7 +355,27 @@ void closeSDL(SDL_Window* window, SDL_Renderer* renderer) {
 
 
 int main(int argc, char* argv[]) {
-    srand(time(0));
+    int fpsCap = DEFAULT_FPS_CAP;
+    bool frameStats = false;
+    const char* bankPath = nullptr;
+    const char* recordPath = nullptr;
+    uint64_t masterSeed = ((uint64_t)random_device{}() << 32) | random_device{}();
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fpsCap = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            masterSeed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--frame-stats") == 0) {
+            frameStats = true;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            gTracePath = argv[++i];
+            enableTracing(true);
+        } else if (strcmp(argv[i], "--bank") == 0 && i + 1 < argc) {
+            bankPath = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+    }
 
 
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
@@ -522,7 +414,7 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE);
     if (renderer == nullptr) {
         cerr << "Renderer khong the tao! SDL_Error: " << SDL_GetError() << endl;
         closeSDL(window, nullptr);
@@ -531,355 +423,143 @@ int main(int argc, char* argv[]) {
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 
 
-    gFont = TTF_OpenFont("C:\\Windows\\Fonts\\Arialbd.ttf", 36);
-    gFontSmall = TTF_OpenFont("C:\\Windows\\Fonts\\Arial.ttf", 18);
-    if (gFont == nullptr || gFontSmall == nullptr) {
-        cerr << "Khong tai duoc font! SDL_ttf Error: " << TTF_GetError() << endl;
-        closeSDL(window, renderer);
-        return 1;
+    // Without the bundle every asset is read as a loose file; fonts then come
+    // from the system font directory.
+    if (!openAssetBundle(gBundle, ASSET_BUNDLE_PATH)) {
+        cerr << "Khong mo duoc " << ASSET_BUNDLE_PATH << ", tai tung file rieng." << endl;
     }
+    startAssetLoader(gAssets, min(defaultThreadCount(), MAX_LOADER_THREADS), &gBundle,
+                     {"", "C:\\Windows\\Fonts\\"});
+    requestStartupAssets();
+
+
+    // Every puzzle seed comes from the master seed, so --seed replays a session.
+    initGameSession(gSession, masterSeed);
+    gSession.bank = &gPuzzleBank;
+    gSession.pool = &gPuzzlePool;
+    gSession.saver = &gSaveWriter;
+    uint64_t poolSeed = nextRandom(gSession.rng);
+    // With a bank nothing is generated in the background; a difficulty the
+    // bank has no puzzles for is generated on demand instead.
+    if (bankPath != nullptr && !openPuzzleBank(gPuzzleBank, bankPath)) {
+        cerr << "Khong mo duoc kho de " << bankPath << ", se tao de moi." << endl;
+    }
+    if (gPuzzleBank.header == nullptr) startPuzzlePool(gPuzzlePool, gSession.symmetry, poolSeed);
+    initFrameScheduler(gFrames, fpsCap, frameStats);
+
+
+    // A finished save is not offered, but its sequence number is carried on
+    // so stale journal records can never be mistaken for new ones.
+    GameSnapshot saved;
+    vector<MoveRecord> savedMoves;
+    bool canResume = false;
+    if (loadSavedGame(SAVE_PATH, JOURNAL_PATH, saved, savedMoves)) {
+        gSaveWriter.sequence = saved.sequence;
+        canResume = !saved.finished;
+    }
+    startSaveWriter(gSaveWriter, SAVE_PATH, JOURNAL_PATH);
 
 
-    gSoundCorrect = loadSound("C:\\Users\\ADMIN\\Documents\\DemoSDl\\SUDOKUfianl\\sudoku\\bin\\moving.mp3");
-    gSoundWrong = loadSound("C:\\Users\\ADMIN\\Documents\\DemoSDl\\SUDOKUfianl\\sudoku\\bin\\moving.mp3");
-
-
-    gBackgroundMusic = loadMusic("background.mp3");
-
-
-    backgroundTexture = loadTexture("C:\\Users\\ADMIN\\Documents\\DemoSDl\\SUDOKUfianl\\sudoku\\bin\\Debug\\bikiniBottom.jpg", renderer);
-
-
-    int triesLeft = 5;
-    vector<vector<int>> sudokuSolution(GRID_SIZE, vector<int>(GRID_SIZE, 0));
-    vector<vector<int>> sudokuGrid(GRID_SIZE, vector<int>(GRID_SIZE, 0));
-    vector<vector<bool>> isOriginal(GRID_SIZE, vector<bool>(GRID_SIZE, false));
-    int difficulty = 40;
-    int timeLeft = GAME_DURATION;
-    Uint32 startTime = 0;
-    Uint32 pauseStartTime = 0;
-    Uint32 totalPausedTime = 0;
-
-
-    auto resetGame = [&]() {
-        buildSudoku(sudokuSolution);
-        sudokuGrid = sudokuSolution;
-        isOriginal.assign(GRID_SIZE, vector<bool>(GRID_SIZE, true));
-
-        int holesToMake = GRID_SIZE * GRID_SIZE - difficulty;
-        if (holesToMake < 10) holesToMake = 10;
-        if (holesToMake > 60) holesToMake = 60;
-
-        random_device rd;
-        mt19937 gen(rd());
-        uniform_int_distribution<> distrib(0, GRID_SIZE * GRID_SIZE - 1);
-
-        vector<bool> cellRemoved(GRID_SIZE * GRID_SIZE, false);
-        int holesMade = 0;
-
-
-        while(holesMade < holesToMake) {
-             int cellIndex = distrib(gen);
-             if (!cellRemoved[cellIndex]) {
-                 int row = cellIndex / GRID_SIZE;
-                 int col = cellIndex % GRID_SIZE;
-                 sudokuGrid[row][col] = 0;
-                 isOriginal[row][col] = false;
-                 cellRemoved[cellIndex] = true;
-                 holesMade++;
-             }
-        }
-
-
-        triesLeft = 5;
-        timeLeft = GAME_DURATION;
-        gameState = RUNNING;
-        selectedRow = -1;
-        selectedCol = -1;
-        startTime = SDL_GetTicks();
-        totalPausedTime = 0;
-
-
-        if (gBackgroundMusic != nullptr) {
-
-            if (Mix_PlayMusic(gBackgroundMusic, -1) == -1) {
-                 cerr << "Mix_PlayMusic failed: " << Mix_GetError() << endl;
+    auto showTitle = [&]() {
+        char title[64];
+        if (gSession.puzzle.fromBank) snprintf(title, sizeof(title), "Sudoku kho #%" PRIu64, gSession.puzzle.id);
+        else snprintf(title, sizeof(title), "Sudoku #%016" PRIx64, gSession.puzzle.id);
+        SDL_SetWindowTitle(window, title);
+    };
 
-            }
+    auto applyEffects = [&](unsigned effects, Uint32 now) {
+        if (effects & EFFECT_NEW_PUZZLE) {
+            showTitle();
+            logPuzzle(gInputLog, gSession, now);
         }
+        playEffects(effects);
     };
 
 
-    if (!showMenu(renderer)) {
+    bool resume = false;
+    if (!showMenu(renderer, canResume, resume)) {
         closeSDL(window, renderer);
         return 0;
-    } else {
-        resetGame();
-
     }
+    Uint32 now = SDL_GetTicks();
+    applyEffects(resume ? restoreGame(gSession, saved, savedMoves, now) : startNewGame(gSession, now), now);
+    if (recordPath != nullptr) openInputLog(gInputLog, recordPath, gSession, resume ? &saved : nullptr, savedMoves, now);
 
 
     bool quit = false;
     SDL_Event event;
 
     while (!quit) {
-
-        while (SDL_PollEvent(&event) != 0) {
+        bool haveEvent = waitFrameEvent(gFrames, event);
+        now = SDL_GetTicks();
+        for (; haveEvent; haveEvent = SDL_PollEvent(&event) != 0) {
+            TRACE_SCOPE("handleEvent");
+            if (eventChangesFrame(event)) requestRedraw(gFrames);
             if (event.type == SDL_QUIT) {
                 quit = true;
                 Mix_HaltMusic();
+            } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3) {
+                perfOverlay = !perfOverlay;
+            } else if (event.type == SDL_RENDER_DEVICE_RESET) {
+                freeBoardLayers();
+            } else if (event.type == SDL_RENDER_TARGETS_RESET ||
+                       (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)) {
+                invalidateBoardLayers();
             }
 
-            switch (gameState) {
-                case MENU:
-
-                    break;
-
-                case RUNNING:
-                    if (event.type == SDL_KEYDOWN) {
-                        switch (event.key.keysym.sym) {
-                            case SDLK_ESCAPE:
-                            case SDLK_p:
-                                gameState = PAUSED;
-                                pauseStartTime = SDL_GetTicks();
-                                currentSelection = RESUME;
-                                Mix_PauseMusic();
-                                break;
-                            case SDLK_UP:
-                                if (selectedRow > 0) selectedRow--;
-                                else selectedRow =GRID_SIZE-1;
-                                break;
-                            case SDLK_DOWN:
-                                if (selectedRow < GRID_SIZE - 1) selectedRow++;
-                                else(selectedRow=0);
-                                break;
-                            case SDLK_LEFT:
-                                if (selectedCol > 0) selectedCol--; else selectedCol = GRID_SIZE - 1;
-                                break;
-                            case SDLK_RIGHT:
-                                if (selectedCol < GRID_SIZE - 1) selectedCol++; else selectedCol = 0;
-                                break;
-                            case SDLK_1: case SDLK_KP_1:
-                            case SDLK_2: case SDLK_KP_2:
-                            case SDLK_3: case SDLK_KP_3:
-                            case SDLK_4: case SDLK_KP_4:
-                            case SDLK_5: case SDLK_KP_5:
-                            case SDLK_6: case SDLK_KP_6:
-                            case SDLK_7: case SDLK_KP_7:
-                            case SDLK_8: case SDLK_KP_8:
-                            case SDLK_9: case SDLK_KP_9:
-                            {
-                                int number = (event.key.keysym.sym >= SDLK_KP_1 && event.key.keysym.sym <= SDLK_KP_9)
-                                             ? event.key.keysym.sym - SDLK_KP_1 + 1
-                                             : event.key.keysym.sym - SDLK_0;
-
-                                if (selectedRow != -1 && selectedCol != -1 && !isOriginal[selectedRow][selectedCol]) {
-                                    if (sudokuSolution[selectedRow][selectedCol] == number) {
-                                        sudokuGrid[selectedRow][selectedCol] = number;
-                                          Mix_PlayChannel(-1, gSoundCorrect, 0);
-                                    } else {
-
-                                        if (sudokuGrid[selectedRow][selectedCol] != number) {
-                                             triesLeft--;
-                                              Mix_PlayChannel(-1, gSoundWrong, 0);
-
-                                        }
-                                    }
-                                }
-                                break;
-                            }
-                            case SDLK_BACKSPACE:
-                            case SDLK_DELETE:
-                            case SDLK_0:
-                            case SDLK_KP_0:
-                                if (selectedRow != -1 && selectedCol != -1 && !isOriginal[selectedRow][selectedCol]) {
-                                    sudokuGrid[selectedRow][selectedCol] = 0;
-                                }
-                                break;
-                        }
-                    } else if (event.type == SDL_MOUSEBUTTONDOWN) {
-                        if (event.button.button == SDL_BUTTON_LEFT) {
-                            int mouseX = event.button.x;
-                            int mouseY = event.button.y;
-
-                            if (mouseY >= GAME_AREA_Y_OFFSET && mouseY < SCREEN_HEIGHT) {
-                                selectedCol = mouseX / CELL_SIZE;
-
-                                selectedRow = (mouseY - GAME_AREA_Y_OFFSET) / CELL_SIZE;
-
-
-                                if (selectedCol >= GRID_SIZE) selectedCol = GRID_SIZE - 1;
-                                if (selectedRow >= GRID_SIZE) selectedRow = GRID_SIZE - 1;
-                            } else {
-
-
-
-                            }
-                        }
-                    }
-                    break;
-
-                case PAUSED:
-                    if (event.type == SDL_KEYDOWN) {
-                        switch (event.key.keysym.sym) {
-                            case SDLK_UP:
-                                currentSelection = (PauseMenuSelection)((currentSelection - 1 + 3) % 3);
-                                break;
-                            case SDLK_DOWN:
-                                currentSelection = (PauseMenuSelection)((currentSelection + 1) % 3);
-                                break;
-                            case SDLK_RETURN: case SDLK_KP_ENTER:
-                                switch (currentSelection) {
-                                    case RESUME:
-                                        gameState = RUNNING;
-
-                                        totalPausedTime += (SDL_GetTicks() - pauseStartTime);
-                                        Mix_ResumeMusic();
-                                        break;
-                                    case RESTART:
-                                        resetGame();
-                                        break;
-                                    case QUIT:
-                                        Mix_HaltMusic();
-                                        quit = true;
-                                        break;
-                                }
-                                break;
-                            case SDLK_p:
-                            case SDLK_ESCAPE:
-                                gameState = RUNNING;
-                                totalPausedTime += (SDL_GetTicks() - pauseStartTime);
-                                Mix_ResumeMusic();
-                                break;
-                            case SDLK_r:
-                                resetGame();
-                                break;
-                             case SDLK_q:
-                                Mix_HaltMusic();
-                                quit = true;
-                                break;
-                        }
-                    }
-                     else if (event.type == SDL_MOUSEBUTTONDOWN) {
-                          int mouseX = event.button.x;
-                          int mouseY = event.button.y;
-                          int startY = SCREEN_HEIGHT / 3;
-                          int spacing = 60;
-                          int textHeight = TTF_FontHeight(gFont);
-
-                          SDL_Rect resumeRect = {(SCREEN_WIDTH - 200) / 2, startY, 200, textHeight};
-                          SDL_Rect restartRect = {(SCREEN_WIDTH - 200) / 2, startY + spacing, 200, textHeight};
-                          SDL_Rect quitRect = {(SCREEN_WIDTH - 200) / 2, startY + 2 * spacing, 200, textHeight};
-
-                          SDL_Point mousePoint = {mouseX, mouseY};
-
-                          if (SDL_PointInRect(&mousePoint, &resumeRect)) {
-                                gameState = RUNNING;
-                                totalPausedTime += (SDL_GetTicks() - pauseStartTime);
-                                Mix_ResumeMusic();
-                          } else if (SDL_PointInRect(&mousePoint, &restartRect)) {
-                                resetGame();
-                          } else if (SDL_PointInRect(&mousePoint, &quitRect)) {
-                                Mix_HaltMusic();
-                                quit = true;
-                          }
-                     }
-                    break;
-
-                case GAME_OVER:
-                case WIN:
-
-                    if (event.type == SDL_KEYDOWN) {
-                        if (event.key.keysym.sym == SDLK_r) {
-                            resetGame();
-                        } else if (event.key.keysym.sym == SDLK_q || event.key.keysym.sym == SDLK_ESCAPE) {
-
-                            quit = true;
-                        }
-                    }
-                     else if (event.type == SDL_MOUSEBUTTONDOWN) {
-                         resetGame();
-                     }
-                    break;
-            }
+            GameInput input;
+            if (!translateEvent(event, input)) continue;
+            logInput(gInputLog, input, now);
+            unsigned effects = handleGameInput(gSession, input, now);
+            applyEffects(effects, now);
+            if (effects & EFFECT_QUIT) quit = true;
         }
 
-        if (gameState == RUNNING) {
-
-            Uint32 currentTime = SDL_GetTicks();
-            int elapsedSeconds = (currentTime - startTime - totalPausedTime) / 1000;
-            timeLeft = GAME_DURATION - elapsedSeconds;
-
-            if (timeLeft <= 0) {
-                timeLeft = 0;
-                gameState = GAME_OVER;
-                Mix_HaltMusic();
-            }
-
-            if (triesLeft <= 0) {
-                gameState = GAME_OVER;
-                Mix_HaltMusic();
-            }
-            bool solved = true;
-            for(int i = 0; i < GRID_SIZE; ++i) {
-                for(int j = 0; j < GRID_SIZE; ++j) {
-                    if(sudokuGrid[i][j] == 0) {
-                        solved = false;
-                        break;
-                    }
-                }
-                if(!solved) break;
-            }
-
-
-
-            if (solved) {
-                gameState = WIN;
-                Mix_HaltMusic();
-            }
+        unsigned effects = updateGameClock(gSession, now);
+        if (effects & (EFFECT_CLOCK_TICK | EFFECT_STATE_CHANGED)) requestRedraw(gFrames);
+        if (effects & EFFECT_STATE_CHANGED) logClock(gInputLog, now);
+        applyEffects(effects, now);
+        if (gSession.gameState == RUNNING) {
+            setFrameTick(gFrames, now + 1000 - elapsedPlayMs(gSession, now) % 1000);
+        } else {
+            clearFrameTick(gFrames);
         }
-        drawRectangle(renderer, 0, 0, SCREEN_WIDTH, UI_AREA_HEIGHT, GRAY);
+        if (!collectAssets(renderer)) quit = true;
+        if (!frameDue(gFrames)) continue;
 
-        if (backgroundTexture) {
-             SDL_Rect destRect = {0, GAME_AREA_Y_OFFSET, GAME_AREA_SIZE, GAME_AREA_SIZE};
-             SDL_RenderCopy(renderer, backgroundTexture, NULL, &destRect);
+        GameState gameState = gSession.gameState;
+        beginFrame(gFrames);
+        if (perfOverlay) {
+            drawPerfOverlay(renderer, summarizeFrames(gFrames));
         } else {
-
-             drawRectangle(renderer, 0, GAME_AREA_Y_OFFSET, GAME_AREA_SIZE, GAME_AREA_SIZE, WHITE);
+            drawRectangle(renderer, 0, 0, SCREEN_WIDTH, UI_AREA_HEIGHT, GRAY);
+            drawTimer(renderer, (gSession.timeLeft > 0) ? gSession.timeLeft : 0);
+            drawTries(renderer, (gSession.triesLeft > 0) ? gSession.triesLeft : 0);
+            if (gSession.hintShown && gameState == RUNNING) drawHint(renderer, gSession.hint.technique);
         }
-        drawTimer(renderer, (timeLeft > 0) ? timeLeft : 0);
-        drawTries(renderer, (triesLeft > 0) ? triesLeft : 0);
         if (gameState == RUNNING || gameState == PAUSED) {
-
-            if (selectedRow != -1 && selectedCol != -1) {
-
-                drawRectangle(renderer, selectedCol * CELL_SIZE, selectedRow * CELL_SIZE + GAME_AREA_Y_OFFSET,
-                              CELL_SIZE, CELL_SIZE, HIGHLIGHTED);
-            }
-            for (int i = 0; i <= GRID_SIZE; ++i) {
-                int lineY = i * CELL_SIZE + GAME_AREA_Y_OFFSET;
-                int lineWidth = (i % 3 == 0) ? THICK_LINE_WIDTH : LINE_WIDTH;
-                drawLine(renderer, 0, lineY, GAME_AREA_SIZE, lineY, lineWidth);
-
-                int lineX = i * CELL_SIZE;
-
-                drawLine(renderer, lineX, GAME_AREA_Y_OFFSET, lineX, GAME_AREA_Y_OFFSET + GAME_AREA_SIZE, lineWidth);
-            }
-            for (int row = 0; row < GRID_SIZE; ++row) {
-                for (int col = 0; col < GRID_SIZE; ++col) {
-                    drawNumber(renderer, row, col, sudokuGrid[row][col], isOriginal[row][col]);
-                }
+            int selected = (gSession.selectedRow != -1 && gSession.selectedCol != -1)
+                ? gSession.selectedRow * GRID_SIZE + gSession.selectedCol : -1;
+            if (!renderBoardLayers(renderer, gSession.grid, gSession.state, selected)) {
+                drawBoardDirect(renderer, gSession.grid, gSession.state, selected);
             }
+        } else {
+            drawBackground(renderer, GAME_AREA_Y_OFFSET);
         }
         if (gameState == PAUSED) {
             renderPauseScreen(renderer);
         } else if (gameState == GAME_OVER) {
-            renderGameOverScreen(renderer, triesLeft <= 0 ? "HET LUOT THU!" : "HET GIO!");
+            renderGameOverScreen(renderer, gSession.triesLeft <= 0 ? "HET LUOT THU!" : "HET GIO!");
         } else if (gameState == WIN) {
              renderWinScreen(renderer);
         }
-        SDL_RenderPresent(renderer);
+        endFrame(gFrames);
+        presentFrame(gFrames, renderer);
     }
+    now = SDL_GetTicks();
+    if (gSession.gameState == RUNNING || gSession.gameState == PAUSED) saveGame(gSession, now);
+    closeInputLog(gInputLog, gSession, now);
+    printFrameStats(gFrames);
     closeSDL(window, renderer);
     return 0;
 }
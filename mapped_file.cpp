@@ -0,0 +1,65 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+static bool mapInto(MappedFile& file, const char* path, MapAccess access) {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                access == ACCESS_RANDOM ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN,
+                                nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    file.fileHandle = handle;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) return false;
+    file.size = (size_t)size.QuadPart;
+
+    file.mappingHandle = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (file.mappingHandle == nullptr) return false;
+    file.data = (const char*)MapViewOfFile(file.mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    return file.data != nullptr;
+#else
+    file.fd = open(path, O_RDONLY);
+    if (file.fd < 0) return false;
+
+    struct stat info;
+    if (fstat(file.fd, &info) != 0 || info.st_size == 0) return false;
+    file.size = (size_t)info.st_size;
+
+    void* data = mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+    if (data == MAP_FAILED) return false;
+    madvise(data, file.size, access == ACCESS_RANDOM ? MADV_RANDOM : MADV_SEQUENTIAL);
+    file.data = (const char*)data;
+    return true;
+#endif
+}
+
+bool mapFile(MappedFile& file, const char* path, MapAccess access) {
+    if (mapInto(file, path, access)) return true;
+    unmapFile(file);
+    return false;
+}
+
+void unmapFile(MappedFile& file) {
+#ifdef _WIN32
+    if (file.data != nullptr) UnmapViewOfFile(file.data);
+    if (file.mappingHandle != nullptr) CloseHandle(file.mappingHandle);
+    if (file.fileHandle != nullptr) CloseHandle(file.fileHandle);
+    file.mappingHandle = nullptr;
+    file.fileHandle = nullptr;
+#else
+    if (file.data != nullptr) munmap((void*)file.data, file.size);
+    if (file.fd >= 0) close(file.fd);
+    file.fd = -1;
+#endif
+    file.data = nullptr;
+    file.size = 0;
+}
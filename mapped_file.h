@@ -0,0 +1,28 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// Read-only, whole-file mapping, hinted for one sequential pass unless the
+// caller asks for random access (a puzzle bank read one record at a time).
+enum MapAccess {
+    ACCESS_SEQUENTIAL,
+    ACCESS_RANDOM
+};
+
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// Empty files fail: there is nothing to map.
+bool mapFile(MappedFile& file, const char* path, MapAccess access = ACCESS_SEQUENTIAL);
+void unmapFile(MappedFile& file);
+
+#endif
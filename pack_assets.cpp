@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "asset_bundle.h"
+
+using namespace std;
+
+
+struct PackItem {
+    string name;
+    string source;
+    MappedFile file;
+};
+
+static void printUsage(const char* program) {
+    cerr << "Cach dung: " << program << " DANH_SACH OUTPUT" << endl;
+    cerr << "Moi dong cua DANH_SACH: TEN DUONG_DAN (dong bat dau bang # bi bo qua)" << endl;
+}
+
+static size_t alignUp(size_t value) {
+    return (value + BUNDLE_ALIGNMENT - 1) / BUNDLE_ALIGNMENT * BUNDLE_ALIGNMENT;
+}
+
+static bool readManifest(const char* path, vector<PackItem>& items) {
+    ifstream manifest(path);
+    if (!manifest) {
+        cerr << "Khong mo duoc file " << path << "!" << endl;
+        return false;
+    }
+
+    string line;
+    int lineNumber = 0;
+    while (getline(manifest, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t start = line.find_first_not_of(" \t");
+        if (start == string::npos || line[start] == '#') continue;
+
+        size_t nameEnd = line.find_first_of(" \t", start);
+        size_t sourceStart = nameEnd == string::npos ? string::npos : line.find_first_not_of(" \t", nameEnd);
+        if (sourceStart == string::npos) {
+            cerr << path << ":" << lineNumber << ": thieu duong dan!" << endl;
+            return false;
+        }
+        size_t sourceEnd = line.find_last_not_of(" \t");
+
+        PackItem item;
+        item.name = line.substr(start, nameEnd - start);
+        item.source = line.substr(sourceStart, sourceEnd + 1 - sourceStart);
+        if (item.name.size() >= BUNDLE_NAME_LENGTH) {
+            cerr << path << ":" << lineNumber << ": ten " << item.name << " qua dai!" << endl;
+            return false;
+        }
+        items.push_back(item);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    vector<PackItem> items;
+    if (!readManifest(argv[1], items)) return 1;
+
+    for (PackItem& item : items) {
+        if (!mapFile(item.file, item.source.c_str())) {
+            cerr << "Khong doc duoc file " << item.source << "!" << endl;
+            for (PackItem& opened : items) unmapFile(opened.file);
+            return 1;
+        }
+    }
+
+    BundleHeader header;
+    memcpy(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+    header.version = BUNDLE_VERSION;
+    header.count = (uint32_t)items.size();
+
+    vector<BundleEntry> entries(items.size());
+    size_t offset = alignUp(sizeof(BundleHeader) + entries.size() * sizeof(BundleEntry));
+    for (size_t i = 0; i < items.size(); i++) {
+        memset(entries[i].name, 0, BUNDLE_NAME_LENGTH);
+        memcpy(entries[i].name, items[i].name.data(), items[i].name.size());
+        entries[i].offset = offset;
+        entries[i].size = items[i].file.size;
+        offset = alignUp(offset + items[i].file.size);
+    }
+
+    FILE* out = fopen(argv[2], "wb");
+    if (out == nullptr) {
+        cerr << "Khong mo duoc file " << argv[2] << "!" << endl;
+        for (PackItem& item : items) unmapFile(item.file);
+        return 1;
+    }
+
+    static const char padding[BUNDLE_ALIGNMENT] = {};
+    size_t written = fwrite(&header, sizeof(header), 1, out) == 1 ? sizeof(header) : 0;
+    bool ok = written > 0 && fwrite(entries.data(), sizeof(BundleEntry), entries.size(), out) == entries.size();
+    written += entries.size() * sizeof(BundleEntry);
+    for (size_t i = 0; ok && i < items.size(); i++) {
+        size_t pad = entries[i].offset - written;
+        ok = fwrite(padding, 1, pad, out) == pad
+          && fwrite(items[i].file.data, 1, items[i].file.size, out) == items[i].file.size;
+        written = entries[i].offset + items[i].file.size;
+    }
+    ok = fclose(out) == 0 && ok;
+
+    for (PackItem& item : items) unmapFile(item.file);
+    if (!ok) {
+        cerr << "Ghi file " << argv[2] << " that bai!" << endl;
+        remove(argv[2]);
+        return 1;
+    }
+    cerr << "Da dong goi " << items.size() << " tai nguyen (" << written << " byte) vao " << argv[2] << endl;
+    return 0;
+}
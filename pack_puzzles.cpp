@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "canonical.h"
+#include "grader.h"
+#include "puzzle_bank.h"
+#include "puzzle_io.h"
+#include "solver.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+
+const size_t CHUNK_LINES = 4096;
+
+struct PuzzleLine {
+    const char* text;
+    size_t length;
+};
+
+struct PackedPuzzle {
+    BankRecord record;
+    uint64_t fingerprint;
+    uint64_t line;
+};
+
+struct ChunkResult {
+    vector<PackedPuzzle> puzzles[DIFFICULTY_COUNT];
+    long long invalid = 0;
+    long long notUnique = 0;
+    long long unrated = 0;
+};
+
+static void printUsage(const char* program) {
+    cerr << "Cach dung: " << program << " [-j LUONG] -o OUTPUT FILE..." << endl;
+    cerr << "Moi dong cua FILE la mot de 81 o; de khong duy nhat, qua kho hoac dang cau voi de truoc bi bo qua."
+         << endl;
+}
+
+static void splitLines(const MappedFile& file, vector<PuzzleLine>& lines) {
+    const char* data = file.data;
+    const char* end = data + file.size;
+    while (data < end) {
+        const char* newline = (const char*)memchr(data, '\n', end - data);
+        const char* lineEnd = newline != nullptr ? newline : end;
+        size_t length = lineEnd - data;
+        if (length > 0 && data[length - 1] == '\r') length--;
+        if (length > 0 && data[0] != '#') lines.push_back({data, length});
+        data = lineEnd + 1;
+    }
+}
+
+// Only puzzles with one solution that the grader can finish go in, so every
+// record has a rating and a difficulty. Of puzzles that are isomorphic only
+// the first line is kept; the claims here settle which one that is.
+static void packChunk(const vector<PuzzleLine>& lines, size_t begin, size_t end, DedupTable& dedup,
+                      ChunkResult& result) {
+    uint8_t cells[BOARD_CELLS];
+    MaskSolver solver;
+    GradeResult grade;
+    PackedPuzzle packed;
+
+    for (size_t i = begin; i < end; i++) {
+        if (!parsePuzzleCells(lines[i].text, lines[i].length, cells)) {
+            result.invalid++;
+            continue;
+        }
+        if (!initMaskSolverFromCells(solver, cells) || countSolutionsMasked(solver, 2) != 1) {
+            result.notUnique++;
+            continue;
+        }
+        Difficulty difficulty;
+        if (!gradePuzzleCells(cells, grade) || !bankDifficultyFor(grade.rating, difficulty)) {
+            result.unrated++;
+            continue;
+        }
+        packBankCells(cells, packed.record.cells);
+        packed.record.rating = (uint16_t)grade.rating;
+        packed.fingerprint = canonicalFingerprint(cells);
+        packed.line = i;
+        claimFingerprint(dedup, packed.fingerprint, packed.line);
+        result.puzzles[difficulty].push_back(packed);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int threadCount = defaultThreadCount();
+    const char* outputPath = nullptr;
+    vector<const char*> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (argv[i][0] == '-') {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (outputPath == nullptr || inputs.empty() || threadCount < 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    vector<MappedFile> files(inputs.size());
+    vector<PuzzleLine> lines;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (!mapFile(files[i], inputs[i])) {
+            cerr << "Khong doc duoc file " << inputs[i] << "!" << endl;
+            for (MappedFile& file : files) unmapFile(file);
+            return 1;
+        }
+        splitLines(files[i], lines);
+    }
+
+    size_t chunkCount = (lines.size() + CHUNK_LINES - 1) / CHUNK_LINES;
+    vector<ChunkResult> results(chunkCount);
+    DedupTable dedup;
+    initDedupTable(dedup, lines.size());
+    ThreadPool pool;
+    startThreadPool(pool, threadCount);
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        submitTask(pool, [&, chunk](int) {
+            size_t begin = chunk * CHUNK_LINES;
+            packChunk(lines, begin, min(begin + CHUNK_LINES, lines.size()), dedup, results[chunk]);
+        });
+    }
+    waitThreadPool(pool);
+    stopThreadPool(pool);
+    for (MappedFile& file : files) unmapFile(file);
+
+    // Chunks are merged in input order and the sort is stable, so the same
+    // input always gives the same bank.
+    BankHeader header;
+    memcpy(header.magic, BANK_MAGIC, sizeof(BANK_MAGIC));
+    header.version = BANK_VERSION;
+    header.recordSize = sizeof(BankRecord);
+    vector<BankRecord> records;
+    long long invalid = 0, notUnique = 0, unrated = 0, duplicates = 0;
+    for (int level = 0; level < DIFFICULTY_COUNT; level++) {
+        size_t first = records.size();
+        for (const ChunkResult& result : results) {
+            for (const PackedPuzzle& packed : result.puzzles[level]) {
+                if (isFirstOccurrence(dedup, packed.fingerprint, packed.line)) records.push_back(packed.record);
+                else duplicates++;
+            }
+        }
+        stable_sort(records.begin() + first, records.end(), [](const BankRecord& a, const BankRecord& b) {
+            return a.rating < b.rating;
+        });
+        header.sections[level].first = first;
+        header.sections[level].count = records.size() - first;
+    }
+    for (const ChunkResult& result : results) {
+        invalid += result.invalid;
+        notUnique += result.notUnique;
+        unrated += result.unrated;
+    }
+
+    FILE* out = fopen(outputPath, "wb");
+    if (out == nullptr) {
+        cerr << "Khong mo duoc file " << outputPath << "!" << endl;
+        return 1;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1
+           && fwrite(records.data(), sizeof(BankRecord), records.size(), out) == records.size();
+    ok = fclose(out) == 0 && ok;
+    if (!ok) {
+        cerr << "Ghi file " << outputPath << " that bai!" << endl;
+        remove(outputPath);
+        return 1;
+    }
+
+    cerr << "Da dong goi " << records.size() << " de vao " << outputPath << " (de " << header.sections[EASY].count
+         << ", vua " << header.sections[MEDIUM].count << ", kho " << header.sections[HARD].count << ")" << endl;
+    if (invalid + notUnique + unrated + duplicates > 0) {
+        cerr << "Bo qua " << invalid << " dong hong, " << notUnique << " de khong duy nhat, "
+             << unrated << " de ngoai cac muc do kho, " << duplicates << " de dang cau" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "perf_trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+
+static TraceEvent gEvents[TRACE_CAPACITY];
+static atomic<uint64_t> gNextEvent{0};
+static atomic<bool> gEnabled{false};
+static atomic<uint32_t> gNextThread{0};
+static atomic<int> gTextureAllocations{0};
+
+static uint32_t currentThread() {
+    thread_local uint32_t id = ++gNextThread;
+    return id;
+}
+
+void enableTracing(bool enabled) {
+    gEnabled.store(enabled, memory_order_relaxed);
+}
+
+bool tracingEnabled() {
+    return gEnabled.load(memory_order_relaxed);
+}
+
+uint64_t traceNow() {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void recordTrace(const char* name, uint64_t startNs, uint64_t endNs) {
+    uint64_t slot = gNextEvent.fetch_add(1, memory_order_relaxed);
+    TraceEvent& event = gEvents[slot & (TRACE_CAPACITY - 1)];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    event.thread = currentThread();
+}
+
+void countTextureAllocation() {
+    gTextureAllocations.fetch_add(1, memory_order_relaxed);
+}
+
+int takeTextureAllocations() {
+    return gTextureAllocations.exchange(0, memory_order_relaxed);
+}
+
+bool exportChromeTrace(const char* path) {
+    FILE* out = fopen(path, "wb");
+    if (out == nullptr) {
+        cerr << "Khong mo duoc file " << path << "!" << endl;
+        return false;
+    }
+
+    uint64_t end = gNextEvent.load(memory_order_acquire);
+    uint64_t first = end > (uint64_t)TRACE_CAPACITY ? end - TRACE_CAPACITY : 0;
+    uint64_t origin = 0;
+    for (uint64_t i = first; i < end; i++) {
+        const TraceEvent& event = gEvents[i & (TRACE_CAPACITY - 1)];
+        if (origin == 0 || event.startNs < origin) origin = event.startNs;
+    }
+
+    // Timestamps are microseconds from the oldest event still in the ring.
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (uint64_t i = first; i < end; i++) {
+        const TraceEvent& event = gEvents[i & (TRACE_CAPACITY - 1)];
+        fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                i == first ? "" : ",", event.name, event.thread,
+                (event.startNs - origin) / 1000.0, event.durationNs / 1000.0);
+    }
+    fprintf(out, "\n]}\n");
+
+    bool ok = fclose(out) == 0;
+    if (!ok) cerr << "Khong ghi duoc file " << path << "!" << endl;
+    else cerr << "Da ghi " << (end - first) << " su kien vao " << path << endl;
+    return ok;
+}
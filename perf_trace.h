@@ -0,0 +1,50 @@
+#ifndef PERF_TRACE_H
+#define PERF_TRACE_H
+
+#include <cstdint>
+
+// Scoped timers that write into a fixed ring of the most recent events. A
+// scope costs two steady_clock reads and one slot write while tracing is on
+// and a single relaxed load while it is off, so the hot paths keep them
+// permanently. Nothing here needs SDL; the tools link it too.
+struct TraceEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint32_t thread;
+};
+
+const int TRACE_CAPACITY = 1 << 15;
+
+void enableTracing(bool enabled);
+bool tracingEnabled();
+uint64_t traceNow();
+// `name` must be a string literal, only the pointer is kept.
+void recordTrace(const char* name, uint64_t startNs, uint64_t endNs);
+
+struct TraceScope {
+    const char* name;
+    uint64_t start;
+
+    explicit TraceScope(const char* scopeName) : name(scopeName), start(tracingEnabled() ? traceNow() : 0) {}
+    ~TraceScope() {
+        if (start != 0) recordTrace(name, start, traceNow());
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+// Counted whether or not tracing is on; the frame scheduler takes the count
+// once per frame.
+void countTextureAllocation();
+int takeTextureAllocations();
+
+// Writes the ring as Chrome trace-event JSON (chrome://tracing, Perfetto).
+// Call it once the worker threads have stopped.
+bool exportChromeTrace(const char* path);
+
+#endif
@@ -0,0 +1,101 @@
+#include "puzzle_bank.h"
+#include <cstring>
+#include <iostream>
+#include "solver.h"
+
+using namespace std;
+
+
+static_assert(sizeof(BankRecord) == 36, "BankRecord must stay packed");
+static_assert(BOARD_CELLS == 27 * 3, "the bank format is for 9x9 boards");
+
+void packBankCells(const uint8_t* cells, uint8_t* packed) {
+    memset(packed, 0, BANK_CELL_BYTES);
+    int bit = 0;
+    for (int i = 0; i < BOARD_CELLS; i += 3, bit += 10) {
+        unsigned group = cells[i] * 100 + cells[i + 1] * 10 + cells[i + 2];
+        for (int b = 0; b < 10; b++) {
+            if (group & (1u << b)) packed[(bit + b) / 8] |= (uint8_t)(1u << ((bit + b) % 8));
+        }
+    }
+}
+
+bool unpackBankCells(const uint8_t* packed, uint8_t* cells) {
+    int bit = 0;
+    for (int i = 0; i < BOARD_CELLS; i += 3, bit += 10) {
+        // Ten bits always span two or three bytes starting at bit / 8.
+        unsigned window = packed[bit / 8] | (packed[bit / 8 + 1] << 8);
+        if (bit / 8 + 2 < (int)BANK_CELL_BYTES) window |= packed[bit / 8 + 2] << 16;
+        unsigned group = (window >> (bit % 8)) & 0x3FF;
+        if (group > 999) return false;
+        cells[i] = group / 100;
+        cells[i + 1] = group / 10 % 10;
+        cells[i + 2] = group % 10;
+    }
+    return true;
+}
+
+bool bankDifficultyFor(int rating, Difficulty& difficulty) {
+    for (int level = 0; level < DIFFICULTY_COUNT; level++) {
+        if (rating <= ratingBandFor((Difficulty)level).maxRating) {
+            difficulty = (Difficulty)level;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool validBank(const MappedFile& mapping) {
+    if (mapping.size < sizeof(BankHeader)) return false;
+
+    const BankHeader* header = (const BankHeader*)mapping.data;
+    if (memcmp(header->magic, BANK_MAGIC, sizeof(BANK_MAGIC)) != 0 || header->version != BANK_VERSION
+        || header->recordSize != sizeof(BankRecord)) {
+        return false;
+    }
+    uint64_t capacity = (mapping.size - sizeof(BankHeader)) / sizeof(BankRecord);
+    for (int level = 0; level < DIFFICULTY_COUNT; level++) {
+        const BankSection& section = header->sections[level];
+        if (section.first > capacity || section.count > capacity - section.first) return false;
+    }
+    return true;
+}
+
+bool openPuzzleBank(PuzzleBank& bank, const char* path) {
+    if (!mapFile(bank.mapping, path, ACCESS_RANDOM)) return false;
+
+    if (!validBank(bank.mapping)) {
+        cerr << "File " << path << " khong phai kho de hop le!" << endl;
+        closePuzzleBank(bank);
+        return false;
+    }
+    bank.header = (const BankHeader*)bank.mapping.data;
+    bank.records = (const BankRecord*)(bank.mapping.data + sizeof(BankHeader));
+    return true;
+}
+
+void closePuzzleBank(PuzzleBank& bank) {
+    unmapFile(bank.mapping);
+    bank.header = nullptr;
+    bank.records = nullptr;
+}
+
+uint64_t bankPuzzleCount(const PuzzleBank& bank, Difficulty difficulty) {
+    return bank.header != nullptr ? bank.header->sections[difficulty].count : 0;
+}
+
+bool loadBankPuzzle(const PuzzleBank& bank, Difficulty difficulty, uint64_t index,
+                    Board& solution, Board& puzzle, int* rating) {
+    if (index >= bankPuzzleCount(bank, difficulty)) return false;
+
+    const BankRecord& record = bank.records[bank.header->sections[difficulty].first + index];
+    puzzle.clear();
+    if (!unpackBankCells(record.cells, puzzle.cells)) return false;
+    markGivens(puzzle);
+    refreshCandidates(puzzle);
+
+    solution = puzzle;
+    if (!solveSudokuFast(solution)) return false;
+    if (rating != nullptr) *rating = record.rating;
+    return true;
+}
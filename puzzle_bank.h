@@ -0,0 +1,56 @@
+#ifndef PUZZLE_BANK_H
+#define PUZZLE_BANK_H
+
+#include <cstddef>
+#include <cstdint>
+#include "generator.h"
+#include "mapped_file.h"
+
+// puzzles.bank layout, little-endian:
+//   BankHeader, then fixed-size BankRecords. Records are grouped by
+//   difficulty and sorted by rating inside a group; the header gives each
+//   group's first record and count, so puzzle k of a difficulty is one
+//   multiply away and nothing is parsed or scanned to find it.
+const char BANK_MAGIC[8] = {'S', 'D', 'K', 'B', 'A', 'N', 'K', '\0'};
+const uint32_t BANK_VERSION = 1;
+// Three cells (000-999) fit in 10 bits; 27 groups make 270 bits.
+const size_t BANK_CELL_BYTES = 34;
+
+struct BankSection {
+    uint64_t first;
+    uint64_t count;
+};
+
+struct BankHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    BankSection sections[DIFFICULTY_COUNT];
+};
+
+struct BankRecord {
+    uint8_t cells[BANK_CELL_BYTES];
+    uint16_t rating;
+};
+
+struct PuzzleBank {
+    MappedFile mapping;
+    const BankHeader* header = nullptr;
+    const BankRecord* records = nullptr;
+};
+
+void packBankCells(const uint8_t* cells, uint8_t* packed);
+// False if a group is out of range, which only a damaged file produces.
+bool unpackBankCells(const uint8_t* packed, uint8_t* cells);
+// The difficulty whose rating band takes `rating`; false if none does.
+bool bankDifficultyFor(int rating, Difficulty& difficulty);
+
+bool openPuzzleBank(PuzzleBank& bank, const char* path);
+void closePuzzleBank(PuzzleBank& bank);
+uint64_t bankPuzzleCount(const PuzzleBank& bank, Difficulty difficulty);
+// Unpacks record `index` of the difficulty's section and solves it for the
+// solution, which takes microseconds; the bank only stores the givens.
+bool loadBankPuzzle(const PuzzleBank& bank, Difficulty difficulty, uint64_t index,
+                    Board& solution, Board& puzzle, int* rating = nullptr);
+
+#endif
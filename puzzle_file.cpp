@@ -0,0 +1,49 @@
+#include "puzzle_file.h"
+#include "puzzle_io.h"
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+
+bool openPuzzleFile(MappedPuzzleFile& file, const char* path) {
+    if (!mapFile(file.mapping, path)) {
+        cerr << "Khong anh xa duoc file " << path << "!" << endl;
+        closePuzzleFile(file);
+        return false;
+    }
+
+    const MappedFile& mapping = file.mapping;
+    const char* newline = (const char*)memchr(mapping.data, '\n', mapping.size);
+    if (newline == nullptr) {
+        file.stride = mapping.size;
+        file.lineLength = mapping.size;
+    } else {
+        file.stride = (size_t)(newline - mapping.data) + 1;
+        file.lineLength = file.stride - 1;
+        if (file.lineLength > 0 && mapping.data[file.lineLength - 1] == '\r') file.lineLength--;
+    }
+
+    size_t remainder = mapping.size % file.stride;
+    file.count = mapping.size / file.stride + (remainder >= file.lineLength && remainder > 0 ? 1 : 0);
+    if (file.lineLength < PUZZLE_LINE_LENGTH || (remainder != 0 && remainder < file.lineLength)) {
+        cerr << "File " << path << " khong co do dai dong co dinh!" << endl;
+        closePuzzleFile(file);
+        return false;
+    }
+    return true;
+}
+
+void closePuzzleFile(MappedPuzzleFile& file) {
+    unmapFile(file.mapping);
+    file.count = 0;
+}
+
+bool puzzleLineIntact(const MappedPuzzleFile& file, size_t index) {
+    const MappedFile& mapping = file.mapping;
+    size_t end = index * file.stride + file.lineLength;
+    if (end >= mapping.size) return end == mapping.size;
+
+    char c = mapping.data[end];
+    return c == '\n' || c == '\r';
+}
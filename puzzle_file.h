@@ -0,0 +1,26 @@
+#ifndef PUZZLE_FILE_H
+#define PUZZLE_FILE_H
+
+#include <cstddef>
+#include "mapped_file.h"
+
+// Read-only mapping of a puzzle file whose lines all have the same length.
+// Puzzle k starts at data + k * stride and is parsed in place.
+struct MappedPuzzleFile {
+    MappedFile mapping;
+    size_t stride = 0;
+    size_t lineLength = 0;
+    size_t count = 0;
+};
+
+bool openPuzzleFile(MappedPuzzleFile& file, const char* path);
+void closePuzzleFile(MappedPuzzleFile& file);
+
+inline const char* puzzleAt(const MappedPuzzleFile& file, size_t index) {
+    return file.mapping.data + index * file.stride;
+}
+
+// False if line `index` does not end where the fixed stride says it should.
+bool puzzleLineIntact(const MappedPuzzleFile& file, size_t index);
+
+#endif
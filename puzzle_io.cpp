@@ -0,0 +1,57 @@
+#include "puzzle_io.h"
+
+using namespace std;
+
+
+bool parsePuzzleCells(const char* text, size_t length, uint8_t* cells, int size) {
+    int cellCount = size * size;
+    if (length < (size_t)cellCount) return false;
+
+    for (int i = 0; i < cellCount; i++) {
+        char c = text[i];
+        if (c >= '1' && c <= '9' && c - '0' <= size) {
+            cells[i] = c - '0';
+        } else if (c == '.' || c == '0') {
+            cells[i] = 0;
+        } else if (c >= 'A' && c - 'A' + 10 <= size) {
+            cells[i] = c - 'A' + 10;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <int BOX>
+bool parsePuzzleLine(const char* text, size_t length, BasicBoard<BOX>& board) {
+    board.clear();
+    if (!parsePuzzleCells(text, length, board.cells, BOX * BOX)) return false;
+
+    markGivens(board);
+    refreshCandidates(board);
+    return true;
+}
+
+void appendPuzzleCells(string& text, const uint8_t* cells, int size) {
+    for (int i = 0; i < size * size; i++) {
+        int value = cells[i];
+        if (value == 0) text += '.';
+        else if (value <= 9) text += (char)('0' + value);
+        else text += (char)('A' + value - 10);
+    }
+}
+
+template <int BOX>
+void appendPuzzleLine(string& text, const BasicBoard<BOX>& board) {
+    appendPuzzleCells(text, board.cells, BOX * BOX);
+    text += '\n';
+}
+
+#define INSTANTIATE_PUZZLE_IO(BOX) \
+    template bool parsePuzzleLine<BOX>(const char*, size_t, BasicBoard<BOX>&); \
+    template void appendPuzzleLine<BOX>(string&, const BasicBoard<BOX>&);
+
+INSTANTIATE_PUZZLE_IO(2)
+INSTANTIATE_PUZZLE_IO(3)
+INSTANTIATE_PUZZLE_IO(4)
+INSTANTIATE_PUZZLE_IO(5)
@@ -0,0 +1,20 @@
+#ifndef PUZZLE_IO_H
+#define PUZZLE_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "board.h"
+
+const int PUZZLE_LINE_LENGTH = BOARD_CELLS;
+
+// Reads the first size*size characters of a line; '.' and '0' mark empty
+// cells. Digits above 9 are letters, 'A' for 10 up to 'P' for 25.
+bool parsePuzzleCells(const char* text, size_t length, uint8_t* cells, int size = GRID_SIZE);
+template <int BOX>
+bool parsePuzzleLine(const char* text, size_t length, BasicBoard<BOX>& board);
+void appendPuzzleCells(std::string& text, const uint8_t* cells, int size = GRID_SIZE);
+template <int BOX>
+void appendPuzzleLine(std::string& text, const BasicBoard<BOX>& board);
+
+#endif
@@ -0,0 +1,78 @@
+#include "puzzle_pool.h"
+
+using namespace std;
+
+
+static bool ringFull(const PuzzleRing& ring) {
+    return ring.tail.load(memory_order_relaxed) - ring.head.load(memory_order_acquire) == POOL_CAPACITY;
+}
+
+static bool poolNeedsWork(const PuzzlePool& pool) {
+    for (int level = 0; level < DIFFICULTY_COUNT; level++) {
+        if (!ringFull(pool.rings[level])) return true;
+    }
+    return false;
+}
+
+static void runWorker(PuzzlePool* pool, uint64_t seed) {
+    Rng rng;
+    seedRng(rng, seed);
+
+    while (pool->running.load(memory_order_acquire)) {
+        bool produced = false;
+        for (int level = 0; level < DIFFICULTY_COUNT && pool->running.load(memory_order_relaxed); level++) {
+            PuzzleRing& ring = pool->rings[level];
+            if (ringFull(ring)) continue;
+
+            unsigned tail = ring.tail.load(memory_order_relaxed);
+            PooledPuzzle& slot = ring.slots[tail % POOL_CAPACITY];
+            slot.seed = nextRandom(rng);
+            generatePuzzleFromSeed(slot.seed, (Difficulty)level, pool->symmetry, slot.solution, slot.grid);
+            ring.tail.store(tail + 1, memory_order_release);
+            produced = true;
+        }
+
+        if (!produced) {
+            unique_lock<mutex> lock(pool->wakeMutex);
+            pool->wake.wait(lock, [pool]() {
+                return !pool->running.load(memory_order_acquire) || poolNeedsWork(*pool);
+            });
+        }
+    }
+}
+
+void startPuzzlePool(PuzzlePool& pool, HoleSymmetry symmetry, uint64_t seed) {
+    if (pool.running.load()) return;
+
+    pool.symmetry = symmetry;
+    pool.running.store(true, memory_order_release);
+    pool.worker = thread(runWorker, &pool, seed);
+}
+
+bool popPuzzle(PuzzlePool& pool, Difficulty difficulty, Board& solution, Board& grid, uint64_t& seed) {
+    PuzzleRing& ring = pool.rings[difficulty];
+    unsigned head = ring.head.load(memory_order_relaxed);
+    if (head == ring.tail.load(memory_order_acquire)) return false;
+
+    PooledPuzzle& slot = ring.slots[head % POOL_CAPACITY];
+    solution = slot.solution;
+    grid = slot.grid;
+    seed = slot.seed;
+    ring.head.store(head + 1, memory_order_release);
+
+    // Taking the lock orders this wakeup against the worker's predicate check.
+    {
+        lock_guard<mutex> lock(pool.wakeMutex);
+    }
+    pool.wake.notify_one();
+    return true;
+}
+
+void stopPuzzlePool(PuzzlePool& pool) {
+    {
+        lock_guard<mutex> lock(pool.wakeMutex);
+        pool.running.store(false, memory_order_release);
+    }
+    pool.wake.notify_one();
+    if (pool.worker.joinable()) pool.worker.join();
+}
@@ -0,0 +1,41 @@
+#ifndef PUZZLE_POOL_H
+#define PUZZLE_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "generator.h"
+
+const unsigned POOL_CAPACITY = 8;
+
+struct PooledPuzzle {
+    Board solution;
+    Board grid;
+    uint64_t seed;
+};
+
+// Single-producer/single-consumer ring: the worker pushes at tail, the event
+// thread pops at head. A pop is two flat Board copies.
+struct PuzzleRing {
+    PooledPuzzle slots[POOL_CAPACITY];
+    alignas(64) std::atomic<unsigned> head{0};
+    alignas(64) std::atomic<unsigned> tail{0};
+};
+
+struct PuzzlePool {
+    PuzzleRing rings[DIFFICULTY_COUNT];
+    HoleSymmetry symmetry = SYMMETRY_ROTATIONAL;
+    std::atomic<bool> running{false};
+    std::thread worker;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+};
+
+// Every puzzle gets its own seed drawn from `seed`, and popPuzzle hands it
+// back so the puzzle can be regenerated with generatePuzzleFromSeed.
+void startPuzzlePool(PuzzlePool& pool, HoleSymmetry symmetry, uint64_t seed);
+bool popPuzzle(PuzzlePool& pool, Difficulty difficulty, Board& solution, Board& grid, uint64_t& seed);
+void stopPuzzlePool(PuzzlePool& pool);
+
+#endif
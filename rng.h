@@ -0,0 +1,54 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// xoshiro256** seeded through splitmix64. Generation and carving draw only
+// from this and shuffle with shuffleArray, so a puzzle is a pure function of
+// its 64-bit seed on every platform; std::shuffle and the std distributions
+// are implementation-defined and would not give that.
+struct Rng {
+    uint64_t state[4];
+};
+
+inline uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+inline void seedRng(Rng& rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) rng.state[i] = splitMix64(seed + i);
+}
+
+inline uint64_t nextRandom(Rng& rng) {
+    uint64_t* s = rng.state;
+    uint64_t result = s[1] * 5;
+    result = ((result << 7) | (result >> 57)) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    return result;
+}
+
+// Uniform in [0, bound) by multiply-shift; the bias is below 2^-32.
+inline uint32_t randomBelow(Rng& rng, uint32_t bound) {
+    return (uint32_t)(((nextRandom(rng) >> 32) * bound) >> 32);
+}
+
+template <typename T>
+void shuffleArray(T* items, int count, Rng& rng) {
+    for (int i = count - 1; i > 0; i--) {
+        int j = randomBelow(rng, i + 1);
+        T item = items[i];
+        items[i] = items[j];
+        items[j] = item;
+    }
+}
+
+#endif
@@ -0,0 +1,292 @@
+#include "save_game.h"
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "puzzle_bank.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+using namespace std;
+
+
+const char SAVE_MAGIC[8] = {'S', 'D', 'K', 'S', 'A', 'V', 'E', '\0'};
+const uint32_t SAVE_VERSION = 1;
+
+// On-disk save, little-endian. Digits are packed like the puzzle bank.
+struct SaveFile {
+    char magic[8];
+    uint32_t version;
+    uint32_t sequence;
+    uint64_t puzzleId;
+    uint32_t elapsedMs;
+    uint8_t triesLeft;
+    uint8_t difficulty;
+    uint8_t fromBank;
+    uint8_t finished;
+    uint64_t givenBits[Board::Geometry::GIVEN_WORDS];
+    uint8_t solution[BANK_CELL_BYTES];
+    uint8_t cells[BANK_CELL_BYTES];
+    uint16_t pencil[BOARD_CELLS];
+    uint32_t checksum;
+};
+
+MoveRecord describeDigitMove(const BoardState& state, const Board& board, int cell, int digit) {
+    MoveRecord move;
+    memset(&move, 0, sizeof(move));
+    move.type = MOVE_DIGIT;
+    move.cell = (uint8_t)cell;
+    move.digitBefore = board.cells[cell];
+    move.digitAfter = (uint8_t)digit;
+    move.pencilBefore = state.pencil[cell];
+    move.pencilAfter = digit != 0 ? 0 : state.pencil[cell];
+    if (digit != 0) move.peerMarks = peerPencilMarks(state, cell, digit);
+    return move;
+}
+
+MoveRecord describePencilMove(const BoardState& state, const Board& board, int cell, uint16_t marks) {
+    MoveRecord move = describeDigitMove(state, board, cell, board.cells[cell]);
+    move.type = MOVE_PENCIL;
+    move.peerMarks = 0;
+    move.pencilAfter = marks;
+    return move;
+}
+
+void applyMove(BoardState& state, Board& board, const MoveRecord& move, bool forward) {
+    if (forward) {
+        placeDigit(state, board, move.cell, move.digitAfter);
+        setPencilMarks(state, move.cell, move.pencilAfter);
+        return;
+    }
+
+    // Putting a digit back must not erase marks that were there alongside it.
+    int digit = move.digitBefore;
+    uint32_t kept = digit != 0 ? peerPencilMarks(state, move.cell, digit) : 0;
+    placeDigit(state, board, move.cell, digit);
+    if (digit != 0) restorePeerPencilMarks(state, move.cell, digit, kept);
+    if (move.digitAfter != 0) restorePeerPencilMarks(state, move.cell, move.digitAfter, move.peerMarks);
+    setPencilMarks(state, move.cell, move.pencilBefore);
+}
+
+void clearUndoJournal(UndoJournal& journal) {
+    journal.moves.clear();
+    journal.cursor = 0;
+}
+
+void pushUndoMove(UndoJournal& journal, const MoveRecord& move) {
+    journal.moves.resize(journal.cursor);
+    journal.moves.push_back(move);
+    journal.cursor++;
+}
+
+bool undoMove(UndoJournal& journal, MoveRecord& move) {
+    if (journal.cursor == 0) return false;
+    move = journal.moves[--journal.cursor];
+    return true;
+}
+
+bool redoMove(UndoJournal& journal, MoveRecord& move) {
+    if (journal.cursor == journal.moves.size()) return false;
+    move = journal.moves[journal.cursor++];
+    return true;
+}
+
+void replayMove(UndoJournal& journal, BoardState& state, Board& board, const MoveRecord& move) {
+    MoveRecord ignored;
+    switch (move.type) {
+        case MOVE_DIGIT:
+        case MOVE_PENCIL:
+            applyMove(state, board, move, true);
+            pushUndoMove(journal, move);
+            break;
+        case MOVE_UNDO:
+            applyMove(state, board, move, false);
+            undoMove(journal, ignored);
+            break;
+        case MOVE_REDO:
+            applyMove(state, board, move, true);
+            redoMove(journal, ignored);
+            break;
+        default:
+            break;
+    }
+}
+
+static uint32_t fnv1a(const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+static void encodeSnapshot(const GameSnapshot& snapshot, SaveFile& file) {
+    memset(&file, 0, sizeof(file));
+    memcpy(file.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC));
+    file.version = SAVE_VERSION;
+    file.sequence = snapshot.sequence;
+    file.puzzleId = snapshot.puzzleId;
+    file.elapsedMs = snapshot.elapsedMs;
+    file.triesLeft = (uint8_t)snapshot.triesLeft;
+    file.difficulty = (uint8_t)snapshot.difficulty;
+    file.fromBank = snapshot.fromBank;
+    file.finished = snapshot.finished;
+    memcpy(file.givenBits, snapshot.grid.givenBits, sizeof(file.givenBits));
+    packBankCells(snapshot.solution.cells, file.solution);
+    packBankCells(snapshot.grid.cells, file.cells);
+    memcpy(file.pencil, snapshot.pencil, sizeof(file.pencil));
+    file.checksum = fnv1a(&file, offsetof(SaveFile, checksum));
+}
+
+static bool decodeSnapshot(const SaveFile& file, GameSnapshot& snapshot) {
+    if (memcmp(file.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0 || file.version != SAVE_VERSION
+        || file.checksum != fnv1a(&file, offsetof(SaveFile, checksum)) || file.difficulty >= DIFFICULTY_COUNT) {
+        return false;
+    }
+    snapshot.solution.clear();
+    snapshot.grid.clear();
+    if (!unpackBankCells(file.solution, snapshot.solution.cells) || !unpackBankCells(file.cells, snapshot.grid.cells)) {
+        return false;
+    }
+    memcpy(snapshot.grid.givenBits, file.givenBits, sizeof(file.givenBits));
+    markGivens(snapshot.solution);
+    memcpy(snapshot.pencil, file.pencil, sizeof(snapshot.pencil));
+    snapshot.puzzleId = file.puzzleId;
+    snapshot.elapsedMs = file.elapsedMs;
+    snapshot.sequence = file.sequence;
+    snapshot.triesLeft = file.triesLeft;
+    snapshot.difficulty = (Difficulty)file.difficulty;
+    snapshot.fromBank = file.fromBank != 0;
+    snapshot.finished = file.finished != 0;
+    return true;
+}
+
+static bool replaceFile(const char* from, const char* to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+static void writeSnapshot(SaveWriter& writer, const GameSnapshot& snapshot) {
+    SaveFile file;
+    encodeSnapshot(snapshot, file);
+
+    string temporary = string(writer.savePath) + ".tmp";
+    FILE* out = fopen(temporary.c_str(), "wb");
+    bool ok = out != nullptr && fwrite(&file, sizeof(file), 1, out) == 1;
+    if (out != nullptr) ok = fclose(out) == 0 && ok;
+    if (!ok || !replaceFile(temporary.c_str(), writer.savePath)) {
+        cerr << "Khong luu duoc van choi vao " << writer.savePath << "!" << endl;
+        remove(temporary.c_str());
+        return;
+    }
+
+    // Everything in the journal is now in the save; start it over.
+    if (writer.journal != nullptr) fclose(writer.journal);
+    writer.journal = fopen(writer.journalPath, "wb");
+}
+
+static void appendMove(SaveWriter& writer, const MoveRecord& move) {
+    if (writer.journal == nullptr) writer.journal = fopen(writer.journalPath, "ab");
+    if (writer.journal == nullptr) return;
+    fwrite(&move, sizeof(move), 1, writer.journal);
+    fflush(writer.journal);
+}
+
+static void runSaveWriter(SaveWriter* writer) {
+    unique_lock<mutex> lock(writer->lock);
+    while (true) {
+        writer->wake.wait(lock, [writer]() { return !writer->running || !writer->jobs.empty(); });
+        if (writer->jobs.empty()) break;
+
+        SaveJob job = writer->jobs.front();
+        writer->jobs.pop_front();
+        lock.unlock();
+        if (job.isSnapshot) writeSnapshot(*writer, job.snapshot);
+        else appendMove(*writer, job.move);
+        lock.lock();
+    }
+    if (writer->journal != nullptr) fclose(writer->journal);
+    writer->journal = nullptr;
+}
+
+void startSaveWriter(SaveWriter& writer, const char* savePath, const char* journalPath) {
+    if (writer.running) return;
+
+    writer.savePath = savePath;
+    writer.journalPath = journalPath;
+    writer.running = true;
+    writer.worker = thread(runSaveWriter, &writer);
+}
+
+void stopSaveWriter(SaveWriter& writer) {
+    {
+        lock_guard<mutex> lock(writer.lock);
+        writer.running = false;
+    }
+    writer.wake.notify_one();
+    if (writer.worker.joinable()) writer.worker.join();
+}
+
+static void queueJob(SaveWriter& writer, const SaveJob& job) {
+    {
+        lock_guard<mutex> lock(writer.lock);
+        if (!writer.running) return;
+        writer.jobs.push_back(job);
+    }
+    writer.wake.notify_one();
+}
+
+void queueSnapshot(SaveWriter& writer, GameSnapshot& snapshot) {
+    snapshot.sequence = writer.sequence;
+    writer.movesSinceSnapshot = 0;
+
+    SaveJob job;
+    job.isSnapshot = true;
+    job.snapshot = snapshot;
+    queueJob(writer, job);
+}
+
+void queueMove(SaveWriter& writer, MoveRecord& move) {
+    move.sequence = ++writer.sequence;
+    writer.movesSinceSnapshot++;
+
+    SaveJob job;
+    job.isSnapshot = false;
+    job.move = move;
+    queueJob(writer, job);
+}
+
+bool loadSavedGame(const char* savePath, const char* journalPath, GameSnapshot& snapshot,
+                   vector<MoveRecord>& tail) {
+    tail.clear();
+    FILE* in = fopen(savePath, "rb");
+    if (in == nullptr) return false;
+    SaveFile file;
+    bool ok = fread(&file, sizeof(file), 1, in) == 1;
+    fclose(in);
+    if (!ok || !decodeSnapshot(file, snapshot)) {
+        cerr << "File " << savePath << " khong phai van choi da luu hop le!" << endl;
+        return false;
+    }
+
+    // Records from before the save are skipped; a gap or a torn record ends
+    // the replay.
+    in = fopen(journalPath, "rb");
+    if (in == nullptr) return true;
+    MoveRecord move;
+    while (fread(&move, sizeof(move), 1, in) == 1) {
+        if (move.sequence <= snapshot.sequence) continue;
+        if (move.sequence != snapshot.sequence + 1 || move.cell >= BOARD_CELLS || move.digitAfter > GRID_SIZE
+            || move.digitBefore > GRID_SIZE || move.type > MOVE_REDO) {
+            break;
+        }
+        tail.push_back(move);
+        snapshot.sequence = move.sequence;
+    }
+    fclose(in);
+    return true;
+}
@@ -0,0 +1,115 @@
+#ifndef SAVE_GAME_H
+#define SAVE_GAME_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "board_state.h"
+#include "generator.h"
+
+// One edit of the board, with enough of the state before and after it that
+// it can be applied in either direction without looking at anything else.
+// The same record is the undo entry and the journal entry on disk.
+enum MoveType {
+    MOVE_DIGIT,
+    MOVE_PENCIL,
+    MOVE_MISTAKE,
+    MOVE_UNDO,
+    MOVE_REDO
+};
+
+struct MoveRecord {
+    uint32_t sequence;
+    uint32_t elapsedMs;
+    uint32_t peerMarks;
+    uint16_t pencilBefore;
+    uint16_t pencilAfter;
+    uint8_t type;
+    uint8_t cell;
+    uint8_t digitBefore;
+    uint8_t digitAfter;
+    uint8_t triesLeft;
+    uint8_t reserved[3];
+};
+
+MoveRecord describeDigitMove(const BoardState& state, const Board& board, int cell, int digit);
+MoveRecord describePencilMove(const BoardState& state, const Board& board, int cell, uint16_t marks);
+void applyMove(BoardState& state, Board& board, const MoveRecord& move, bool forward);
+
+// Undo and redo move a cursor over the moves made so far; a new move drops
+// everything after the cursor.
+struct UndoJournal {
+    std::vector<MoveRecord> moves;
+    size_t cursor = 0;
+};
+
+void clearUndoJournal(UndoJournal& journal);
+void pushUndoMove(UndoJournal& journal, const MoveRecord& move);
+// Both return the move to apply (backwards for undo) and false at either end.
+bool undoMove(UndoJournal& journal, MoveRecord& move);
+bool redoMove(UndoJournal& journal, MoveRecord& move);
+// Applies a journal record read back from disk and keeps `journal` in step.
+void replayMove(UndoJournal& journal, BoardState& state, Board& board, const MoveRecord& move);
+
+// Everything needed to resume, copied by value on the render thread.
+struct GameSnapshot {
+    Board solution;
+    Board grid;
+    uint16_t pencil[BOARD_CELLS];
+    uint64_t puzzleId;
+    uint32_t elapsedMs;
+    uint32_t sequence;
+    int triesLeft;
+    Difficulty difficulty;
+    bool fromBank;
+    bool finished;
+};
+
+// A writer thread owns the files. The save is packed on that thread and
+// written with one fwrite to a temporary file that is renamed over the old
+// one, so a crash leaves either the old save or the new one. Moves are
+// appended to the journal and flushed but not fsynced; on load, records up
+// to the save's sequence number are skipped and a torn last record is dropped.
+struct SaveJob {
+    bool isSnapshot;
+    GameSnapshot snapshot;
+    MoveRecord move;
+};
+
+struct SaveWriter {
+    const char* savePath = nullptr;
+    const char* journalPath = nullptr;
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::deque<SaveJob> jobs;
+    bool running = false;
+    FILE* journal = nullptr;
+    // Render thread only.
+    uint32_t sequence = 0;
+    uint32_t movesSinceSnapshot = 0;
+};
+
+const uint32_t SNAPSHOT_INTERVAL_MOVES = 64;
+
+void startSaveWriter(SaveWriter& writer, const char* savePath, const char* journalPath);
+// Finishes the queued writes first.
+void stopSaveWriter(SaveWriter& writer);
+// Stamps the snapshot with the current sequence number and queues it.
+void queueSnapshot(SaveWriter& writer, GameSnapshot& snapshot);
+// Numbers the move and queues it for the journal.
+void queueMove(SaveWriter& writer, MoveRecord& move);
+inline bool snapshotDue(const SaveWriter& writer) {
+    return writer.movesSinceSnapshot >= SNAPSHOT_INTERVAL_MOVES;
+}
+
+// `tail` gets the journal records made after the save, in order, and
+// snapshot.sequence ends up at the last of them.
+bool loadSavedGame(const char* savePath, const char* journalPath, GameSnapshot& snapshot,
+                   std::vector<MoveRecord>& tail);
+
+#endif
@@ -0,0 +1,394 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <vector>
+#include "board_layout.h"
+#include "game_logic.h"
+#include "input_log.h"
+#include "perf_trace.h"
+#include "puzzle_bank.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+
+const long long CHUNK_SESSIONS = 64;
+const int DEFAULT_SESSION_INPUTS = 2000;
+const int MAX_REPORTED_FAILURES = 10;
+const int STATE_COUNT = WIN + 1;
+const char* const STATE_NAMES[STATE_COUNT] = {"MENU", "RUNNING", "PAUSED", "GAME_OVER", "WIN"};
+
+static void printUsage(const char* program) {
+    cerr << "Cach dung: " << program << " -r BAN_GHI [-x LAN] [-b KHO_DE] [-t TRACE]" << endl;
+    cerr << "       " << program << " -n SO_PHIEN [-i THAO_TAC] [-d easy|medium|hard] [-s SEED] [-j LUONG]"
+         << " [-b KHO_DE] [-t TRACE]" << endl;
+    cerr << "-r: chay lai ban ghi thao tac cua game (--record) khong can cua so, -x lan" << endl;
+    cerr << "-n: choi ngau nhien SO_PHIEN phien, moi phien toi da THAO_TAC thao tac, va kiem tra trang thai" << endl;
+}
+
+struct SoakStats {
+    long long sessions = 0;
+    long long inputs = 0;
+    long long games = 0;
+    long long wins = 0;
+    long long losses = 0;
+    long long quits = 0;
+    long long failures = 0;
+    long long simulatedMs = 0;
+    long long resetNs = 0;
+    long long inputsIn[STATE_COUNT] = {};
+    long long transitions[STATE_COUNT][STATE_COUNT] = {};
+};
+
+// Any of these failing means the state machine let something through that
+// the game never should: a wrong digit on the board, a win on an unfinished
+// board, a running game with no tries or time left.
+static const char* checkSession(const GameSession& session) {
+    if (session.gameState < RUNNING || session.gameState > WIN) return "trang thai khong hop le";
+    if (session.triesLeft < 0 || session.triesLeft > MAX_TRIES) return "so luot thu ngoai khoang";
+    if (session.gameState == RUNNING && (session.triesLeft <= 0 || session.timeLeft <= 0)) {
+        return "van dang chay khi da het luot hoac het gio";
+    }
+    if (session.gameState == WIN && !boardComplete(session.state)) return "thang khi bang chua xong";
+    if (session.selectedRow < -1 || session.selectedRow >= GRID_SIZE
+        || session.selectedCol < -1 || session.selectedCol >= GRID_SIZE) {
+        return "o duoc chon ngoai bang";
+    }
+    if (session.undo.cursor > session.undo.moves.size()) return "con tro hoan tac ngoai nhat ky";
+
+    int filled = 0;
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        int digit = session.grid.cells[cell];
+        if (digit == 0) continue;
+        filled++;
+        if (digit != session.solution.cells[cell]) return "so sai nam tren bang";
+        if (session.state.pencil[cell] != 0) return "o da dien van con ghi chu";
+    }
+    if (filled != session.state.filled || session.state.duplicates != 0) return "BoardState lech voi bang";
+    return nullptr;
+}
+
+// A player who mostly fills the selected cell, nearly always with the right
+// digit, and now and then pauses, undoes, asks for a hint or walks away for
+// long enough to run out of time.
+static GameInput randomInput(const GameSession& session, Rng& rng) {
+    GameInput input = {INPUT_CLICK, 1, 0, 0};
+    uint32_t roll = randomBelow(rng, 100);
+    if (session.gameState == PAUSED) {
+        static const uint8_t PAUSED_KEYS[] = {INPUT_UP, INPUT_DOWN, INPUT_CONFIRM, INPUT_PAUSE, INPUT_BACK,
+                                              INPUT_RESTART, INPUT_DIGIT};
+        if (roll < 20) {
+            input.x = (int16_t)randomBelow(rng, SCREEN_WIDTH);
+            input.y = (int16_t)(PAUSE_MENU_Y + randomBelow(rng, 3 * PAUSE_MENU_SPACING));
+        } else if (roll < 21) {
+            input.type = INPUT_QUIT;
+        } else {
+            input.type = PAUSED_KEYS[randomBelow(rng, sizeof(PAUSED_KEYS))];
+            input.value = 1;
+        }
+        return input;
+    }
+    if (session.gameState != RUNNING) {
+        if (roll < 60) input.type = INPUT_RESTART;
+        else if (roll < 95) input.value = (uint8_t)randomBelow(rng, 2);
+        else input.type = roll < 98 ? INPUT_QUIT : INPUT_BACK;
+        input.x = (int16_t)randomBelow(rng, SCREEN_WIDTH);
+        input.y = (int16_t)randomBelow(rng, SCREEN_HEIGHT);
+        return input;
+    }
+
+    if (roll < 30) {
+        // Clicks go for empty cells, with a few misses and right clicks.
+        for (int attempt = 0; attempt < 8; attempt++) {
+            input.x = (int16_t)randomBelow(rng, SCREEN_WIDTH);
+            input.y = (int16_t)randomBelow(rng, SCREEN_HEIGHT);
+            int row, col;
+            if (hitTestCell(input.x, input.y, row, col) && session.grid.get(row, col) == 0) break;
+        }
+        input.value = roll < 29;
+    } else if (roll < 75) {
+        input.type = INPUT_DIGIT;
+        input.value = (uint8_t)(randomBelow(rng, GRID_SIZE) + 1);
+        if (randomBelow(rng, 16) != 0 && session.selectedRow >= 0 && session.selectedCol >= 0) {
+            input.value = session.solution.get(session.selectedRow, session.selectedCol);
+        }
+    } else if (roll < 80) {
+        input.type = INPUT_PENCIL;
+        input.value = (uint8_t)(randomBelow(rng, GRID_SIZE) + 1);
+    } else if (roll < 82) {
+        input.type = INPUT_ERASE;
+    } else if (roll < 88) {
+        input.type = (uint8_t)(INPUT_UP + randomBelow(rng, 4));
+    } else if (roll < 92) {
+        input.type = roll < 90 ? INPUT_UNDO : INPUT_REDO;
+    } else if (roll < 97) {
+        input.type = INPUT_HINT;
+    } else if (roll < 99) {
+        input.type = roll < 98 ? INPUT_PAUSE : INPUT_BACK;
+    } else {
+        static const uint8_t IGNORED_KEYS[] = {INPUT_CONFIRM, INPUT_RESTART, INPUT_QUIT};
+        input.type = IGNORED_KEYS[randomBelow(rng, sizeof(IGNORED_KEYS))];
+    }
+    return input;
+}
+
+static void reportFailure(long long index, int step, const char* message) {
+    static mutex lock;
+    static int reported = 0;
+    lock_guard<mutex> guard(lock);
+    if (reported++ < MAX_REPORTED_FAILURES) {
+        cerr << "Phien " << index << ", thao tac " << step << ": " << message << endl;
+    }
+}
+
+static void countTransition(SoakStats& stats, GameState before, GameState after) {
+    if (after == before) return;
+    stats.transitions[before][after]++;
+    if (after == WIN) stats.wins++;
+    else if (after == GAME_OVER) stats.losses++;
+}
+
+static void soakChunk(uint64_t masterSeed, long long first, long long end, int maxInputs,
+                      Difficulty difficulty, PuzzleBank* bank, SoakStats& stats) {
+    GameSession session;
+    Rng player;
+    for (long long index = first; index < end; index++) {
+        uint64_t seed = splitMix64(masterSeed ^ splitMix64((uint64_t)index));
+        initGameSession(session, seed);
+        session.difficulty = difficulty;
+        session.bank = bank;
+        seedRng(player, ~seed);
+
+        uint32_t now = 0;
+        auto start = chrono::steady_clock::now();
+        startNewGame(session, now);
+        stats.resetNs += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        stats.games++;
+        stats.sessions++;
+
+        for (int step = 0; step < maxInputs; step++) {
+            now += randomBelow(player, 1000) == 0 ? 300000 + randomBelow(player, 1800000) : randomBelow(player, 1500);
+            GameState before = session.gameState;
+            unsigned effects = updateGameClock(session, now);
+            countTransition(stats, before, session.gameState);
+
+            GameInput input = randomInput(session, player);
+            before = session.gameState;
+            stats.inputsIn[before]++;
+            start = chrono::steady_clock::now();
+            effects |= handleGameInput(session, input, now);
+            if (effects & EFFECT_NEW_PUZZLE) {
+                stats.resetNs += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start)
+                                     .count();
+                stats.games++;
+            }
+            stats.inputs++;
+            countTransition(stats, before, session.gameState);
+
+            before = session.gameState;
+            effects |= updateGameClock(session, now);
+            countTransition(stats, before, session.gameState);
+
+            const char* failure = checkSession(session);
+            if (failure != nullptr) {
+                stats.failures++;
+                reportFailure(index, step, failure);
+                break;
+            }
+            if (effects & EFFECT_QUIT) {
+                stats.quits++;
+                break;
+            }
+        }
+        stats.simulatedMs += now;
+    }
+}
+
+static void addStats(SoakStats& total, const SoakStats& chunk) {
+    total.sessions += chunk.sessions;
+    total.inputs += chunk.inputs;
+    total.games += chunk.games;
+    total.wins += chunk.wins;
+    total.losses += chunk.losses;
+    total.quits += chunk.quits;
+    total.failures += chunk.failures;
+    total.simulatedMs += chunk.simulatedMs;
+    total.resetNs += chunk.resetNs;
+    for (int from = 0; from < STATE_COUNT; from++) {
+        total.inputsIn[from] += chunk.inputsIn[from];
+        for (int to = 0; to < STATE_COUNT; to++) total.transitions[from][to] += chunk.transitions[from][to];
+    }
+}
+
+static int runSoak(long long sessions, int maxInputs, Difficulty difficulty, uint64_t masterSeed, int threadCount,
+                   PuzzleBank* bank) {
+    long long chunkCount = (sessions + CHUNK_SESSIONS - 1) / CHUNK_SESSIONS;
+    vector<SoakStats> results(chunkCount);
+    ThreadPool pool;
+    startThreadPool(pool, threadCount);
+    auto startTime = chrono::steady_clock::now();
+    for (long long chunk = 0; chunk < chunkCount; chunk++) {
+        submitTask(pool, [&, chunk](int) {
+            long long first = chunk * CHUNK_SESSIONS;
+            soakChunk(masterSeed, first, min(first + CHUNK_SESSIONS, sessions), maxInputs, difficulty, bank,
+                      results[chunk]);
+        });
+    }
+    waitThreadPool(pool);
+    stopThreadPool(pool);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    SoakStats total;
+    for (const SoakStats& chunk : results) addStats(total, chunk);
+    cerr << "Da choi " << total.sessions << " phien, " << total.inputs << " thao tac trong " << seconds << " s ("
+         << (seconds > 0 ? total.inputs / seconds : 0) << " thao tac/s, nhanh gap "
+         << (seconds > 0 ? total.simulatedMs / 1000.0 / seconds : 0) << " lan thoi gian thuc), seed " << masterSeed
+         << endl;
+    cerr << total.games << " van (" << total.wins << " thang, " << total.losses << " thua, " << total.quits
+         << " thoat), trung binh " << (total.games > 0 ? total.resetNs / 1000.0 / total.games : 0)
+         << " us moi lan resetGame" << endl;
+    for (int from = RUNNING; from < STATE_COUNT; from++) {
+        cerr << STATE_NAMES[from] << ": " << total.inputsIn[from] << " thao tac";
+        for (int to = RUNNING; to < STATE_COUNT; to++) {
+            if (total.transitions[from][to] > 0) cerr << ", -> " << STATE_NAMES[to] << " " << total.transitions[from][to];
+        }
+        cerr << endl;
+    }
+    if (total.failures > 0) {
+        cerr << "Co " << total.failures << " phien vi pham trang thai!" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Feeds the recording through the game logic exactly as the event loop did:
+// inputs in order, clock updates where one ended the game, and the recorded
+// puzzles in place of fresh ones.
+static bool replayScript(const InputScript& script, PuzzleBank* bank, GameSession& session, bool& checked) {
+    initGameSession(session, 0);
+    session.difficulty = (Difficulty)script.header.difficulty;
+    session.symmetry = (HoleSymmetry)script.header.symmetry;
+    session.bank = bank;
+    for (const InputRecord& record : script.records) {
+        if (record.kind == RECORD_PUZZLE) session.scripted.push_back({record.data, record.flags != 0});
+    }
+    if (script.header.resumed) restoreGame(session, script.saved, script.moves, 0);
+    else startNewGame(session, 0);
+
+    checked = false;
+    for (const InputRecord& record : script.records) {
+        switch (record.kind) {
+            case RECORD_INPUT:
+                handleGameInput(session, record.input, record.timeMs);
+                break;
+            case RECORD_CLOCK:
+                updateGameClock(session, record.timeMs);
+                break;
+            case RECORD_END:
+                checked = true;
+                return hashGameSession(session) == record.data;
+        }
+    }
+    return true;
+}
+
+static int runReplay(const char* path, int repeats, PuzzleBank* bank) {
+    InputScript script;
+    if (!loadInputScript(path, script)) return 1;
+    for (const InputRecord& record : script.records) {
+        if (record.kind == RECORD_PUZZLE && record.flags != 0 && bank == nullptr) {
+            cerr << "Ban ghi dung de trong kho, can them -b KHO_DE!" << endl;
+            return 1;
+        }
+    }
+
+    GameSession session;
+    bool matched = true;
+    bool checked = false;
+    auto startTime = chrono::steady_clock::now();
+    for (int i = 0; i < repeats && matched; i++) matched = replayScript(script, bank, session, checked);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    uint32_t recordedMs = script.records.empty() ? 0 : script.records.back().timeMs;
+    long long inputs = 0;
+    for (const InputRecord& record : script.records) inputs += record.kind == RECORD_INPUT;
+    cerr << "Da chay lai " << inputs << " thao tac x " << repeats << " lan trong " << seconds << " s (nhanh gap "
+         << (seconds > 0 ? recordedMs / 1000.0 * repeats / seconds : 0) << " lan thoi gian thuc)" << endl;
+    cerr << "Trang thai cuoi " << STATE_NAMES[session.gameState] << ", con " << session.triesLeft << " luot thu, "
+         << session.state.filled << "/" << BOARD_CELLS << " o" << endl;
+    if (!checked) {
+        cerr << "Ban ghi bi cat ngang, khong co trang thai cuoi de so sanh." << endl;
+    } else if (!matched) {
+        cerr << "Trang thai khi chay lai khac voi luc ghi!" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    const char* replayPath = nullptr;
+    const char* bankPath = nullptr;
+    const char* tracePath = nullptr;
+    int repeats = 1;
+    long long sessions = -1;
+    int maxInputs = DEFAULT_SESSION_INPUTS;
+    Difficulty difficulty = MEDIUM;
+    uint64_t masterSeed = ((uint64_t)random_device{}() << 32) | random_device{}();
+    int threadCount = defaultThreadCount();
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (strcmp(argv[i - 1], "-r") == 0) {
+            replayPath = value;
+        } else if (strcmp(argv[i - 1], "-x") == 0) {
+            repeats = atoi(value);
+        } else if (strcmp(argv[i - 1], "-n") == 0) {
+            sessions = strtoll(value, nullptr, 10);
+        } else if (strcmp(argv[i - 1], "-i") == 0) {
+            maxInputs = atoi(value);
+        } else if (strcmp(argv[i - 1], "-d") == 0) {
+            if (strcmp(value, "easy") == 0) difficulty = EASY;
+            else if (strcmp(value, "hard") == 0) difficulty = HARD;
+            else difficulty = MEDIUM;
+        } else if (strcmp(argv[i - 1], "-s") == 0) {
+            masterSeed = strtoull(value, nullptr, 10);
+        } else if (strcmp(argv[i - 1], "-j") == 0) {
+            threadCount = atoi(value);
+        } else if (strcmp(argv[i - 1], "-b") == 0) {
+            bankPath = value;
+        } else if (strcmp(argv[i - 1], "-t") == 0) {
+            tracePath = value;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if ((replayPath == nullptr) == (sessions < 0) || repeats < 1 || maxInputs < 1 || threadCount < 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    PuzzleBank bank;
+    if (bankPath != nullptr && !openPuzzleBank(bank, bankPath)) {
+        cerr << "Khong mo duoc kho de " << bankPath << "!" << endl;
+        return 1;
+    }
+    if (tracePath != nullptr) enableTracing(true);
+
+    int status = replayPath != nullptr
+        ? runReplay(replayPath, repeats, bankPath != nullptr ? &bank : nullptr)
+        : runSoak(sessions, maxInputs, difficulty, masterSeed, threadCount, bankPath != nullptr ? &bank : nullptr);
+
+    if (tracePath != nullptr) exportChromeTrace(tracePath);
+    closePuzzleBank(bank);
+    return status;
+}
@@ -0,0 +1,333 @@
+#include "solver.h"
+#include <cstring>
+
+using namespace std;
+
+
+const int64_t FILL_NODE_BUDGET = 4;
+
+// Row, column and box of every cell, and the cells of every unit (rows,
+// then columns, then boxes), built at compile time for each size.
+template <int BOX>
+struct CellUnits {
+    uint8_t row[BoardGeometry<BOX>::CELLS];
+    uint8_t col[BoardGeometry<BOX>::CELLS];
+    uint8_t box[BoardGeometry<BOX>::CELLS];
+    uint16_t unitCells[3 * BOX * BOX][BOX * BOX];
+};
+
+template <int BOX>
+static constexpr CellUnits<BOX> makeCellUnits() {
+    CellUnits<BOX> units = {};
+    for (int cell = 0; cell < BoardGeometry<BOX>::CELLS; cell++) {
+        int row = cell / (BOX * BOX);
+        int col = cell % (BOX * BOX);
+        units.row[cell] = row;
+        units.col[cell] = col;
+        int box = (row / BOX) * BOX + col / BOX;
+        units.box[cell] = box;
+        units.unitCells[row][col] = cell;
+        units.unitCells[BOX * BOX + col][row] = cell;
+        units.unitCells[2 * BOX * BOX + box][(row % BOX) * BOX + col % BOX] = cell;
+    }
+    return units;
+}
+
+template <int BOX>
+static constexpr CellUnits<BOX> CELL_UNITS = makeCellUnits<BOX>();
+
+template <typename Mask>
+static inline int bitCount(Mask mask) {
+    return __builtin_popcount(mask);
+}
+
+template <typename Mask>
+static inline int lowestDigit(Mask bit) {
+    return __builtin_ctz(bit) + 1;
+}
+
+
+template <int BOX>
+static inline typename BasicMaskSolver<BOX>::Mask candidatesOf(const BasicMaskSolver<BOX>& s, int cell) {
+    const CellUnits<BOX>& units = CELL_UNITS<BOX>;
+    return BoardGeometry<BOX>::ALL_DIGITS
+        & ~(s.rowUsed[units.row[cell]] | s.colUsed[units.col[cell]] | s.boxUsed[units.box[cell]]);
+}
+
+template <int BOX>
+static inline void place(BasicMaskSolver<BOX>& s, int cell, typename BasicMaskSolver<BOX>::Mask bit) {
+    const CellUnits<BOX>& units = CELL_UNITS<BOX>;
+    s.rowUsed[units.row[cell]] |= bit;
+    s.colUsed[units.col[cell]] |= bit;
+    s.boxUsed[units.box[cell]] |= bit;
+    s.cells[cell] = lowestDigit(bit);
+}
+
+template <int BOX>
+static inline void unplace(BasicMaskSolver<BOX>& s, int cell, typename BasicMaskSolver<BOX>::Mask bit) {
+    const CellUnits<BOX>& units = CELL_UNITS<BOX>;
+    s.rowUsed[units.row[cell]] &= ~bit;
+    s.colUsed[units.col[cell]] &= ~bit;
+    s.boxUsed[units.box[cell]] &= ~bit;
+    s.cells[cell] = 0;
+}
+
+template <typename Mask>
+static inline Mask pickBit(Mask mask, Rng* rng) {
+    if (rng == nullptr) return mask & -mask;
+
+    int skip = randomBelow(*rng, bitCount(mask));
+    while (skip-- > 0) mask &= mask - 1;
+    return mask & -mask;
+}
+
+// A digit with a single place left in some unit, as (slot, bit). Returns
+// false when a unit has no place left for a digit it still needs.
+template <int BOX>
+static bool findHiddenSingle(const BasicMaskSolver<BOX>& s, int& slot, typename BasicMaskSolver<BOX>::Mask& bit) {
+    typedef typename BasicMaskSolver<BOX>::Mask Mask;
+    const int size = BOX * BOX;
+    const CellUnits<BOX>& units = CELL_UNITS<BOX>;
+
+    slot = -1;
+    for (int unit = 0; unit < 3 * size; unit++) {
+        Mask once = 0;
+        Mask twice = 0;
+        for (int k = 0; k < size; k++) {
+            int cell = units.unitCells[unit][k];
+            if (s.cells[cell]) continue;
+            Mask mask = candidatesOf(s, cell);
+            twice |= once & mask;
+            once |= mask;
+        }
+
+        const Mask* used = unit < size ? s.rowUsed : unit < 2 * size ? s.colUsed : s.boxUsed;
+        if ((once | used[unit % size]) != BoardGeometry<BOX>::ALL_DIGITS) return false;
+
+        Mask single = once & ~twice;
+        if (single == 0) continue;
+        bit = single & -single;
+        for (int k = 0; k < size; k++) {
+            int cell = units.unitCells[unit][k];
+            if (s.cells[cell] || !(candidatesOf(s, cell) & bit)) continue;
+            for (slot = 0; s.empty[slot] != cell; slot++) {}
+            return true;
+        }
+    }
+    return true;
+}
+
+// Picks the empty slot with the fewest candidates and returns how many it
+// has. From 16x16 up a hidden single is taken before any guess: the unit
+// scan costs more than it saves on 9x9, but the bigger boards are out of
+// reach without it.
+template <int BOX>
+static int chooseSlot(const BasicMaskSolver<BOX>& s, int& bestSlot, typename BasicMaskSolver<BOX>::Mask& bestMask) {
+    typedef typename BasicMaskSolver<BOX>::Mask Mask;
+    bestSlot = 0;
+    bestMask = 0;
+    int bestCount = BOX * BOX + 1;
+    for (int i = 0; i < s.emptyCount; i++) {
+        Mask mask = candidatesOf(s, s.empty[i]);
+        int count = bitCount(mask);
+        if (count < bestCount) {
+            bestSlot = i;
+            bestCount = count;
+            bestMask = mask;
+            if (count <= 1) return count;
+        }
+    }
+
+    if constexpr (BOX >= 4) {
+        int slot;
+        Mask bit;
+        if (!findHiddenSingle(s, slot, bit)) return 0;
+        if (slot >= 0) {
+            bestSlot = slot;
+            bestMask = bit;
+            return 1;
+        }
+    }
+    return bestCount;
+}
+
+template <int BOX>
+static bool search(BasicMaskSolver<BOX>& s, Rng* rng) {
+    typedef typename BasicMaskSolver<BOX>::Mask Mask;
+    if (s.emptyCount == 0) return true;
+    if (s.nodesLeft == 0) return false;
+    s.nodesLeft--;
+
+    int bestSlot;
+    Mask bestMask;
+    int bestCount = chooseSlot(s, bestSlot, bestMask);
+    if (bestCount == 0) return false;
+
+    int cell = s.empty[bestSlot];
+    s.empty[bestSlot] = s.empty[--s.emptyCount];
+
+    while (bestMask) {
+        Mask bit = pickBit(bestMask, rng);
+        bestMask &= ~bit;
+
+        place(s, cell, bit);
+        if (search(s, rng)) return true;
+        unplace(s, cell, bit);
+    }
+
+    s.empty[s.emptyCount++] = s.empty[bestSlot];
+    s.empty[bestSlot] = cell;
+    return false;
+}
+
+template <int BOX>
+static int countSearch(BasicMaskSolver<BOX>& s, int limit) {
+    typedef typename BasicMaskSolver<BOX>::Mask Mask;
+    if (s.emptyCount == 0) return 1;
+    if (s.nodesLeft == 0) return 0;
+    s.nodesLeft--;
+
+    int bestSlot;
+    Mask bestMask;
+    int bestCount = chooseSlot(s, bestSlot, bestMask);
+    if (bestCount == 0) return 0;
+
+    int cell = s.empty[bestSlot];
+    s.empty[bestSlot] = s.empty[--s.emptyCount];
+
+    int found = 0;
+    while (bestMask && found < limit) {
+        Mask bit = bestMask & -bestMask;
+        bestMask &= ~bit;
+
+        place(s, cell, bit);
+        found += countSearch(s, limit - found);
+        unplace(s, cell, bit);
+    }
+
+    s.empty[s.emptyCount++] = s.empty[bestSlot];
+    s.empty[bestSlot] = cell;
+    return found;
+}
+
+template <int BOX>
+bool initMaskSolverFromCells(BasicMaskSolver<BOX>& solver, const uint8_t* cells) {
+    typedef typename BasicMaskSolver<BOX>::Mask Mask;
+    const int size = BOX * BOX;
+    for (int i = 0; i < size; i++) {
+        solver.rowUsed[i] = 0;
+        solver.colUsed[i] = 0;
+        solver.boxUsed[i] = 0;
+    }
+    solver.emptyCount = 0;
+    solver.nodesLeft = -1;
+
+    for (int cell = 0; cell < size * size; cell++) {
+        int value = cells[cell];
+        if (value == 0) {
+            solver.cells[cell] = 0;
+            solver.empty[solver.emptyCount++] = cell;
+            continue;
+        }
+        if (value > size) return false;
+        Mask bit = (Mask)1 << (value - 1);
+        if (!(candidatesOf(solver, cell) & bit)) return false;
+        place(solver, cell, bit);
+    }
+    return true;
+}
+
+template <int BOX>
+bool initMaskSolver(BasicMaskSolver<BOX>& solver, const BasicBoard<BOX>& board) {
+    return initMaskSolverFromCells(solver, board.cells);
+}
+
+template <int BOX>
+bool solveMasked(BasicMaskSolver<BOX>& solver, Rng* rng) {
+    return search(solver, rng);
+}
+
+template <int BOX>
+int countSolutionsMasked(BasicMaskSolver<BOX>& solver, int limit) {
+    if (limit <= 0) return 0;
+    return countSearch(solver, limit);
+}
+
+template <int BOX>
+void setCell(BasicMaskSolver<BOX>& solver, int cell, int digit) {
+    typedef typename BasicMaskSolver<BOX>::Mask Mask;
+    for (int i = 0; i < solver.emptyCount; i++) {
+        if (solver.empty[i] == cell) {
+            solver.empty[i] = solver.empty[--solver.emptyCount];
+            place(solver, cell, (Mask)1 << (digit - 1));
+            return;
+        }
+    }
+}
+
+template <int BOX>
+bool hasSolutionWithout(const BasicMaskSolver<BOX>& solver, int cell, int digit) {
+    typedef typename BasicMaskSolver<BOX>::Mask Mask;
+    Mask alternatives = candidatesOf(solver, cell) & ~((Mask)1 << (digit - 1));
+    while (alternatives) {
+        Mask bit = alternatives & -alternatives;
+        alternatives &= ~bit;
+
+        BasicMaskSolver<BOX> trial = solver;
+        setCell(trial, cell, lowestDigit(bit));
+        if (search(trial, nullptr) || trial.nodesLeft == 0) return true;
+    }
+    return false;
+}
+
+template <int BOX>
+static void copyBack(const BasicMaskSolver<BOX>& solver, BasicBoard<BOX>& board) {
+    memcpy(board.cells, solver.cells, sizeof(solver.cells));
+}
+
+template <int BOX>
+bool solveSudokuFast(BasicBoard<BOX>& board) {
+    BasicMaskSolver<BOX> solver;
+    if (!initMaskSolver(solver, board) || !solveMasked(solver, nullptr)) return false;
+    copyBack(solver, board);
+    return true;
+}
+
+template <int BOX>
+bool fillSudokuRandom(BasicBoard<BOX>& board, Rng& rng) {
+    BasicMaskSolver<BOX> start;
+    if (!initMaskSolver(start, board)) return false;
+
+    for (int64_t budget = FILL_NODE_BUDGET * BoardGeometry<BOX>::CELLS; ; budget *= 2) {
+        BasicMaskSolver<BOX> solver = start;
+        solver.nodesLeft = budget;
+        if (solveMasked(solver, &rng)) {
+            copyBack(solver, board);
+            return true;
+        }
+        if (solver.nodesLeft != 0) return false;
+    }
+}
+
+template <int BOX>
+int countSolutionsFast(const BasicBoard<BOX>& board, int limit) {
+    BasicMaskSolver<BOX> solver;
+    if (!initMaskSolver(solver, board)) return 0;
+    return countSolutionsMasked(solver, limit);
+}
+
+#define INSTANTIATE_SOLVER(BOX) \
+    template bool initMaskSolver<BOX>(BasicMaskSolver<BOX>&, const BasicBoard<BOX>&); \
+    template bool initMaskSolverFromCells<BOX>(BasicMaskSolver<BOX>&, const uint8_t*); \
+    template bool solveMasked<BOX>(BasicMaskSolver<BOX>&, Rng*); \
+    template int countSolutionsMasked<BOX>(BasicMaskSolver<BOX>&, int); \
+    template void setCell<BOX>(BasicMaskSolver<BOX>&, int, int); \
+    template bool hasSolutionWithout<BOX>(const BasicMaskSolver<BOX>&, int, int); \
+    template bool solveSudokuFast<BOX>(BasicBoard<BOX>&); \
+    template bool fillSudokuRandom<BOX>(BasicBoard<BOX>&, Rng&); \
+    template int countSolutionsFast<BOX>(const BasicBoard<BOX>&, int);
+
+INSTANTIATE_SOLVER(2)
+INSTANTIATE_SOLVER(3)
+INSTANTIATE_SOLVER(4)
+INSTANTIATE_SOLVER(5)
@@ -0,0 +1,53 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <cstdint>
+#include "board.h"
+#include "rng.h"
+
+const int SOLVER_CELLS = BOARD_CELLS;
+const uint16_t ALL_DIGITS = Board::Geometry::ALL_DIGITS;
+
+// Bit d-1 of each mask marks digit d as used in that row/column/box.
+// Instantiated for box edges 2 to 5 in solver.cpp.
+template <int BOX>
+struct BasicMaskSolver {
+    typedef BoardGeometry<BOX> Geometry;
+    typedef typename Geometry::Mask Mask;
+
+    uint8_t cells[Geometry::CELLS];
+    Mask rowUsed[Geometry::SIZE];
+    Mask colUsed[Geometry::SIZE];
+    Mask boxUsed[Geometry::SIZE];
+    typename Geometry::CellIndex empty[Geometry::CELLS];
+    int emptyCount;
+    // Searches give up when this reaches zero; negative means no limit.
+    int64_t nodesLeft;
+};
+
+typedef BasicMaskSolver<BOX_SIZE> MaskSolver;
+
+template <int BOX>
+bool initMaskSolver(BasicMaskSolver<BOX>& solver, const BasicBoard<BOX>& board);
+template <int BOX>
+bool initMaskSolverFromCells(BasicMaskSolver<BOX>& solver, const uint8_t* cells);
+template <int BOX>
+bool solveMasked(BasicMaskSolver<BOX>& solver, Rng* rng);
+template <int BOX>
+int countSolutionsMasked(BasicMaskSolver<BOX>& solver, int limit);
+template <int BOX>
+void setCell(BasicMaskSolver<BOX>& solver, int cell, int digit);
+// True if some solution puts a digit other than `digit` into the empty `cell`,
+// or if the search ran out of nodes before it could rule that out.
+template <int BOX>
+bool hasSolutionWithout(const BasicMaskSolver<BOX>& solver, int cell, int digit);
+template <int BOX>
+bool solveSudokuFast(BasicBoard<BOX>& board);
+// Restarts with a larger node budget whenever a random fill stalls, which
+// keeps the heavy tail of the bigger boards in check.
+template <int BOX>
+bool fillSudokuRandom(BasicBoard<BOX>& board, Rng& rng);
+template <int BOX>
+int countSolutionsFast(const BasicBoard<BOX>& board, int limit);
+
+#endif
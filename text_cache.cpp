@@ -0,0 +1,197 @@
+#include "text_cache.h"
+#include <iostream>
+#include <map>
+#include <utility>
+#include "perf_trace.h"
+
+using namespace std;
+
+
+const int FIRST_GLYPH = 32;
+const int LAST_GLYPH = 126;
+const int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+const int ATLAS_WIDTH = 1024;
+const int ATLAS_HEIGHT = 512;
+const SDL_Color GLYPH_WHITE = {255, 255, 255, 255};
+
+struct GlyphAtlas {
+    SDL_Texture* texture = nullptr;
+    SDL_Surface* pending = nullptr;
+    SDL_Rect glyphs[ATLAS_FONT_COUNT][GLYPH_COUNT];
+    int lineHeight[ATLAS_FONT_COUNT];
+};
+
+struct CachedText {
+    SDL_Texture* texture;
+    int w;
+    int h;
+};
+
+static GlyphAtlas gAtlas;
+static map<pair<TTF_Font*, string>, CachedText> gTextCache;
+
+
+static void tint(SDL_Texture* texture, SDL_Color color) {
+    SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(texture, color.a);
+}
+
+static bool packFont(SDL_Surface* atlas, TTF_Font* font, AtlasFont slot, int& x, int& y, int& rowHeight) {
+    gAtlas.lineHeight[slot] = TTF_FontHeight(font);
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        SDL_Rect& rect = gAtlas.glyphs[slot][i];
+        rect = {0, 0, 0, 0};
+
+        SDL_Surface* glyph = TTF_RenderGlyph_Solid(font, (Uint16)(FIRST_GLYPH + i), GLYPH_WHITE);
+        if (glyph == nullptr) continue;
+
+        if (x + glyph->w > ATLAS_WIDTH) {
+            x = 0;
+            y += rowHeight + 1;
+            rowHeight = 0;
+        }
+        if (y + glyph->h > ATLAS_HEIGHT) {
+            SDL_FreeSurface(glyph);
+            cerr << "Atlas ky tu khong du cho!" << endl;
+            return false;
+        }
+
+        rect = {x, y, glyph->w, glyph->h};
+        SDL_Rect dest = rect;
+        SDL_BlitSurface(glyph, nullptr, atlas, &dest);
+        x += glyph->w + 1;
+        if (glyph->h > rowHeight) rowHeight = glyph->h;
+        SDL_FreeSurface(glyph);
+    }
+    return true;
+}
+
+bool buildGlyphAtlas(TTF_Font* font, TTF_Font* fontSmall) {
+    TRACE_SCOPE("buildGlyphAtlas");
+    if (font == nullptr || fontSmall == nullptr) return false;
+
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, ATLAS_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+    if (atlas == nullptr) {
+        cerr << "Khong the tao surface cho atlas! SDL Error: " << SDL_GetError() << endl;
+        return false;
+    }
+
+    int x = 0, y = 0, rowHeight = 0;
+    bool packed = packFont(atlas, font, ATLAS_LARGE, x, y, rowHeight)
+               && packFont(atlas, fontSmall, ATLAS_SMALL, x, y, rowHeight);
+    if (!packed) {
+        SDL_FreeSurface(atlas);
+        return false;
+    }
+    gAtlas.pending = atlas;
+    return true;
+}
+
+bool uploadGlyphAtlas(SDL_Renderer* renderer) {
+    if (gAtlas.pending == nullptr) return false;
+
+    TRACE_SCOPE("uploadGlyphAtlas");
+    gAtlas.texture = SDL_CreateTextureFromSurface(renderer, gAtlas.pending);
+    countTextureAllocation();
+    if (gAtlas.texture == nullptr) {
+        cerr << "Khong the tao texture cho atlas! SDL Error: " << SDL_GetError() << endl;
+    } else {
+        SDL_SetTextureBlendMode(gAtlas.texture, SDL_BLENDMODE_BLEND);
+    }
+    SDL_FreeSurface(gAtlas.pending);
+    gAtlas.pending = nullptr;
+    return gAtlas.texture != nullptr;
+}
+
+bool initTextCache(SDL_Renderer* renderer, TTF_Font* font, TTF_Font* fontSmall) {
+    return buildGlyphAtlas(font, fontSmall) && uploadGlyphAtlas(renderer);
+}
+
+void freeTextCache() {
+    SDL_DestroyTexture(gAtlas.texture);
+    gAtlas.texture = nullptr;
+    SDL_FreeSurface(gAtlas.pending);
+    gAtlas.pending = nullptr;
+    for (auto& entry : gTextCache) SDL_DestroyTexture(entry.second.texture);
+    gTextCache.clear();
+}
+
+static const SDL_Rect* glyphRect(AtlasFont font, char c) {
+    if (c < FIRST_GLYPH || c > LAST_GLYPH) c = '?';
+    return &gAtlas.glyphs[font][c - FIRST_GLYPH];
+}
+
+void drawGlyph(SDL_Renderer* renderer, AtlasFont font, char c, const SDL_Rect& cell, SDL_Color color) {
+    if (gAtlas.texture == nullptr) return;
+
+    const SDL_Rect* src = glyphRect(font, c);
+    SDL_Rect dest = {cell.x + (cell.w - src->w) / 2, cell.y + (cell.h - src->h) / 2, src->w, src->h};
+    tint(gAtlas.texture, color);
+    SDL_RenderCopy(renderer, gAtlas.texture, src, &dest);
+}
+
+int glyphTextWidth(AtlasFont font, const char* text) {
+    int width = 0;
+    for (const char* c = text; *c; c++) width += glyphRect(font, *c)->w;
+    return width;
+}
+
+int glyphTextHeight(AtlasFont font) {
+    return gAtlas.lineHeight[font];
+}
+
+void drawGlyphText(SDL_Renderer* renderer, AtlasFont font, const char* text, int x, int y, SDL_Color color) {
+    if (gAtlas.texture == nullptr) return;
+
+    tint(gAtlas.texture, color);
+    for (const char* c = text; *c; c++) {
+        const SDL_Rect* src = glyphRect(font, *c);
+        SDL_Rect dest = {x, y, src->w, src->h};
+        SDL_RenderCopy(renderer, gAtlas.texture, src, &dest);
+        x += src->w;
+    }
+}
+
+static const CachedText* findText(SDL_Renderer* renderer, TTF_Font* font, const string& text) {
+    if (font == nullptr) return nullptr;
+
+    auto key = make_pair(font, text);
+    auto found = gTextCache.find(key);
+    if (found != gTextCache.end()) return &found->second;
+
+    TRACE_SCOPE("rasteriseText");
+    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), GLYPH_WHITE);
+    if (surface == nullptr) {
+        cerr << "Khong the render text surface! SDL_ttf Error: " << TTF_GetError() << endl;
+        return nullptr;
+    }
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    countTextureAllocation();
+    CachedText cached = {texture, surface->w, surface->h};
+    SDL_FreeSurface(surface);
+    if (texture == nullptr) {
+        cerr << "Khong the tao texture tu text! SDL Error: " << SDL_GetError() << endl;
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return &gTextCache.emplace(key, cached).first->second;
+}
+
+void drawCachedText(SDL_Renderer* renderer, TTF_Font* font, const string& text, int x, int y, SDL_Color color) {
+    const CachedText* cached = findText(renderer, font, text);
+    if (cached == nullptr) return;
+
+    SDL_Rect dest = {x, y, cached->w, cached->h};
+    tint(cached->texture, color);
+    SDL_RenderCopy(renderer, cached->texture, nullptr, &dest);
+}
+
+void drawCachedTextCentered(SDL_Renderer* renderer, TTF_Font* font, const string& text,
+                            int areaWidth, int y, SDL_Color color) {
+    const CachedText* cached = findText(renderer, font, text);
+    if (cached == nullptr) return;
+
+    SDL_Rect dest = {(areaWidth - cached->w) / 2, y, cached->w, cached->h};
+    tint(cached->texture, color);
+    SDL_RenderCopy(renderer, cached->texture, nullptr, &dest);
+}
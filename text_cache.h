@@ -0,0 +1,35 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <string>
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+enum AtlasFont {
+    ATLAS_LARGE,
+    ATLAS_SMALL,
+    ATLAS_FONT_COUNT
+};
+
+// Rasterises printable ASCII for both fonts into one white texture at startup.
+// Drawing tints the atlas with SDL_SetTextureColorMod, so a digit in any
+// colour is a single SDL_RenderCopy with no surface or texture allocation.
+bool initTextCache(SDL_Renderer* renderer, TTF_Font* font, TTF_Font* fontSmall);
+// The same in two halves: rasterising needs no renderer and can run on a
+// loader thread, the upload must happen on the render thread afterwards.
+bool buildGlyphAtlas(TTF_Font* font, TTF_Font* fontSmall);
+bool uploadGlyphAtlas(SDL_Renderer* renderer);
+void freeTextCache();
+
+void drawGlyph(SDL_Renderer* renderer, AtlasFont font, char c, const SDL_Rect& cell, SDL_Color color);
+int glyphTextWidth(AtlasFont font, const char* text);
+void drawGlyphText(SDL_Renderer* renderer, AtlasFont font, const char* text, int x, int y, SDL_Color color);
+int glyphTextHeight(AtlasFont font);
+
+// Whole strings that never change (menus, overlays) are rendered once and kept.
+void drawCachedText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text,
+                    int x, int y, SDL_Color color);
+void drawCachedTextCentered(SDL_Renderer* renderer, TTF_Font* font, const std::string& text,
+                            int areaWidth, int y, SDL_Color color);
+
+#endif
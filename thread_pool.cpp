@@ -0,0 +1,85 @@
+#include "thread_pool.h"
+
+using namespace std;
+
+
+static bool takeTask(ThreadPool& pool, int self, PoolTask& task) {
+    int count = (int)pool.queues.size();
+    for (int k = 0; k < count; k++) {
+        int victim = (self + k) % count;
+        WorkerQueue& queue = *pool.queues[victim];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty()) continue;
+
+        if (victim == self) {
+            task = move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        pool.queued.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+static void runWorker(ThreadPool* pool, int self) {
+    PoolTask task;
+    while (true) {
+        if (takeTask(*pool, self, task)) {
+            task(self);
+            task = nullptr;
+            if (pool->pending.fetch_sub(1) == 1) {
+                lock_guard<mutex> guard(pool->stateLock);
+                pool->allDone.notify_all();
+            }
+            continue;
+        }
+
+        unique_lock<mutex> guard(pool->stateLock);
+        pool->workReady.wait(guard, [pool]() { return pool->queued.load() > 0 || !pool->running.load(); });
+        if (pool->queued.load() == 0) return;
+    }
+}
+
+int defaultThreadCount() {
+    int count = (int)thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+void startThreadPool(ThreadPool& pool, int threadCount) {
+    if (threadCount < 1) threadCount = 1;
+
+    pool.running.store(true);
+    for (int i = 0; i < threadCount; i++) pool.queues.emplace_back(new WorkerQueue());
+    for (int i = 0; i < threadCount; i++) pool.workers.emplace_back(runWorker, &pool, i);
+}
+
+void submitTask(ThreadPool& pool, PoolTask task) {
+    WorkerQueue& queue = *pool.queues[pool.nextQueue++ % pool.queues.size()];
+    pool.pending.fetch_add(1);
+    {
+        lock_guard<mutex> guard(queue.lock);
+        queue.tasks.push_back(move(task));
+        pool.queued.fetch_add(1);
+    }
+    lock_guard<mutex> guard(pool.stateLock);
+    pool.workReady.notify_one();
+}
+
+void waitThreadPool(ThreadPool& pool) {
+    unique_lock<mutex> guard(pool.stateLock);
+    pool.allDone.wait(guard, [&pool]() { return pool.pending.load() == 0; });
+}
+
+void stopThreadPool(ThreadPool& pool) {
+    {
+        lock_guard<mutex> guard(pool.stateLock);
+        pool.running.store(false);
+    }
+    pool.workReady.notify_all();
+    for (thread& worker : pool.workers) worker.join();
+    pool.workers.clear();
+    pool.queues.clear();
+}
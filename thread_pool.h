@@ -0,0 +1,42 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Tasks receive the index of the worker running them, so callers can keep
+// per-worker state (RNG, solver scratch) without locking.
+typedef std::function<void(int)> PoolTask;
+
+struct WorkerQueue {
+    std::mutex lock;
+    std::deque<PoolTask> tasks;
+};
+
+// Each worker pops from the back of its own queue and steals from the front
+// of the others when it runs dry.
+struct ThreadPool {
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> queued{0};
+    std::atomic<int> pending{0};
+    std::atomic<bool> running{false};
+    unsigned nextQueue = 0;
+    std::mutex stateLock;
+    std::condition_variable workReady;
+    std::condition_variable allDone;
+};
+
+int defaultThreadCount();
+void startThreadPool(ThreadPool& pool, int threadCount);
+void submitTask(ThreadPool& pool, PoolTask task);
+void waitThreadPool(ThreadPool& pool);
+void stopThreadPool(ThreadPool& pool);
+
+#endif